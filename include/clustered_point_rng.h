@@ -0,0 +1,26 @@
+#ifndef CLUSTERED_POINT_RNG_H_DEFINED
+#define CLUSTERED_POINT_RNG_H_DEFINED
+
+#include <random>
+#include <tuple>
+#include "quadedge_structure/vertex.h"
+
+class clustered_point_rng
+{
+private:
+    T minValue[2], maxValue[2];
+    T spread[2];
+    std::vector <point> centers;
+    std::mt19937 gen;
+    std::uniform_int_distribution <int> clusterDist;
+    std::normal_distribution <T> dist;
+public:
+    clustered_point_rng(){}
+    clustered_point_rng(T, T, T, T, int numClusters, T relativeSpread = 0.02);
+    clustered_point_rng(const std::tuple <T, T, T, T>&, int numClusters, T relativeSpread = 0.02);
+
+    point getRandom();
+    std::vector <point> getRandom(int);
+};
+
+#endif
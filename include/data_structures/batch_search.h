@@ -0,0 +1,39 @@
+#ifndef BATCH_SEARCH_H_DEFINED
+#define BATCH_SEARCH_H_DEFINED
+
+/*
+* Runs numSearches binary searches in lockstep, search g looks at the indices [base[g], base[g] + size[g]) where isBelow(g, i) holds for a prefix
+* Every round advances each search by one step and prefetches the index its next step reads, so the cache misses of all searches overlap
+* Afterwards base[g] is the last index of the prefix, or the first index of the range if the prefix is empty (size[g] must be positive)
+* prefetch(g, i) is given the index that search g reads in its next step
+* Index is int for small arrays, or size_t for arrays that can outgrow int
+*/
+template <class Index, class Predicate, class Prefetch>
+void batchBinarySearch(int numSearches, Index* base, Index* size, Predicate isBelow, Prefetch prefetch)
+{
+    for (int g = 0; g < numSearches; g++)
+    {
+        if (size[g] > 1)
+            prefetch(g, base[g] + size[g] / 2);
+    }
+    bool active = true;
+    while (active)
+    {
+        active = false;
+        for (int g = 0; g < numSearches; g++)
+        {
+            if (size[g] <= 1) continue;
+            Index half = size[g] / 2;
+            // Written as a select so that the step does not depend on a branch prediction
+            base[g] = isBelow(g, base[g] + half) ? base[g] + half : base[g];
+            size[g] -= half;
+            if (size[g] > 1)
+            {
+                prefetch(g, base[g] + size[g] / 2);
+                active = true;
+            }
+        }
+    }
+}
+
+#endif
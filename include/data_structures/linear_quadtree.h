@@ -0,0 +1,97 @@
+#ifndef LINEAR_QUADTREE_H_DEFINED
+#define LINEAR_QUADTREE_H_DEFINED
+
+#include <vector>
+#include <tuple>
+#include <cstddef>
+#include <functional>
+#include "quadedge_structure/vertex.h"
+#include "data_structures/triangle_block.h"
+
+class edge;
+
+/*
+* Quadtree without pointers, only its leaves are stored
+* Every leaf is identified by the Morton code of its lower left corner at the finest level, so sorting leaves by code orders them along the Z-curve
+* Leaves cover the whole root cell (empty ones included), so the leaf containing a point is the last one whose code is at most the code of the point
+* Faces overlapping leaf i are stored as indices into faces in face_ids[leaves[i].begin, leaves[i].begin + leaves[i].size)
+* Each leaf is padded to a multiple of 4 slots (with id -1) and slot j also has its coordinates in lane j % 4 of blocks[j / 4]
+*
+* insert and remove edit the slots of the leaves that a face overlaps in place, slots of removed faces become holes with id -1 like padding
+* A leaf without a hole grows into the free slots after it, or is moved to the end of the slots with room to double
+* A leaf is split once it holds MAX_OVERLAP faces, like a node of a pointer quadtree, and the slots are packed again once more than half of them are unused
+*/
+class linear_quadtree
+{
+private:
+    struct leaf_buffer;
+    struct leaf_slots;
+    struct leaf_cell;
+    std::vector <unsigned long long> leaf_codes;
+    std::vector <leaf_slots> leaves;
+    std::vector <int> face_ids;
+    std::vector <triangle_block> blocks;
+    std::vector <edge*> faces; // NULL for removed faces, whose ids are in free_ids until they are reused
+    std::vector <int> free_ids;
+    size_t numUnusedSlots = 0; // Slots left behind by moved and split leaves
+    T left, top, right, bottom, width, height;
+    int codeDepth, depth;
+
+    int MAX_OVERLAP, MAX_DEPTH;
+
+    static const int BATCH_SIZE = 16; // Number of queries of a batch whose searches run in lockstep
+
+    static unsigned long long interleave(unsigned int x, unsigned int y);
+    std::tuple <T, T, T, T> cellBounds(unsigned int cx, unsigned int cy, int level) const;
+    bool canSplit(unsigned int cx, unsigned int cy, int level) const;
+    unsigned long long pointCode(const point &p) const;
+    void build(const std::vector <int>&, unsigned int cx, unsigned int cy, int level, const std::function <std::tuple <T, T, T, T>(int)>&, int, leaf_buffer&) const;
+
+    void findLeaves(const std::tuple <T, T, T, T>&, unsigned int cx, unsigned int cy, int level, std::vector <leaf_cell>&) const;
+    void setSlot(size_t, int);
+    leaf_slots appendSlots(const int*, int, int);
+    int addToLeaf(int, int);
+    void splitLeaf(const leaf_cell&);
+    void compact();
+public:
+    // Codes are 64 bit with 2 bits per level
+    static const int MAX_CODE_DEPTH = 31;
+
+    linear_quadtree(){}
+    void setParameters(int, int);
+
+    void init(const std::tuple <T, T, T, T>& bounding_box, const std::vector <edge*> &dual_faces, const std::vector <std::tuple <T, T, T, T>> &face_boxes, int numThreads = 1);
+    void insert(edge* face);
+    void remove(const std::vector <edge*> &face_keys, const std::tuple <T, T, T, T>& face_box);
+    edge* locate(const point &p, leafScanMode mode = simdScan);
+    void locate_batch(const point* points, size_t numPoints, edge** located, leafScanMode mode = simdScan);
+
+    int getNumNodes();
+    int getDepth();
+    size_t getMemoryUsage();
+};
+
+// Leaves of a subtree in Morton order, subtrees built by different threads are concatenated afterwards
+struct linear_quadtree::leaf_buffer
+{
+    std::vector <unsigned long long> codes;
+    std::vector <int> sizes;
+    std::vector <int> ids;
+    int depth = 0;
+};
+
+// Slots [begin, begin + size) of face_ids hold the faces of a leaf, the slots up to begin + capacity are free for it to grow into
+struct linear_quadtree::leaf_slots
+{
+    int begin, size, capacity;
+};
+
+// Leaf along with the cell it covers
+struct linear_quadtree::leaf_cell
+{
+    int leaf;
+    unsigned int cx, cy;
+    int level;
+};
+
+#endif
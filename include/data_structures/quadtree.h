@@ -3,7 +3,9 @@
 
 #include <vector>
 #include <tuple>
+#include <cstddef>
 #include "quadedge_structure/vertex.h"
+#include "data_structures/triangle_block.h"
 
 class edge;
 
@@ -11,25 +13,44 @@ class quadtree
 {
 private:
     quadtree* children[4];
-    long long left, top, right, bottom;
+    T left, top, right, bottom;
     std::vector <edge*> faces;
+    std::vector <triangle_block> blocks; // Coordinates of faces packed for the leaf scan, face i is in lane i % 4 of block i / 4
     int level;
 
     int MAX_OVERLAP, MAX_DEPTH;
 
+    static const int BATCH_SIZE = 16; // Number of queries of a batch that descend in lockstep
+
     bool contains(const point&);
+    bool canSplit();
     bool overlaps(edge* face);
+    bool overlaps(edge* face, const std::tuple <T, T, T, T>& face_box);
+    void createChildren();
     void split();
+    void addToLeaf(edge* face);
+    void packLeaf();
+    void buildNode(const std::vector <edge*>&, const std::vector <std::tuple <T, T, T, T>>&, const std::vector <int>&, int);
 public:
     quadtree(){}
     quadtree(const std::tuple <T, T, T, T>& bounding_box, int lev = 0);
     void setParameters(int, int);
 
     void insert(edge* face);
-    edge* locate(const point &p);
+    void remove(const std::vector <edge*> &face_keys, const std::tuple <T, T, T, T>& face_box);
+    void build(const std::vector <edge*> &all_faces, const std::vector <std::tuple <T, T, T, T>> &face_boxes, int numThreads = 1);
+    edge* locate(const point &p, leafScanMode mode = simdScan);
+    void locate_batch(const point* points, size_t numPoints, edge** located, leafScanMode mode = simdScan);
 
     int getNumNodes();
     int getDepth();
+    size_t getMemoryUsage();
 };
 
+// Geometry shared by the quadtree backends
+// face is a dual edge outwards from a triangular face
+std::tuple <T, T, T, T> faceBoundingBox(edge* face);
+bool boxOverlapsFace(const std::tuple <T, T, T, T>& bounding_box, edge* face);
+bool boxOverlapsFace(const std::tuple <T, T, T, T>& bounding_box, edge* face, const std::tuple <T, T, T, T>& face_box);
+
 #endif
@@ -0,0 +1,37 @@
+#ifndef TRIANGLE_BLOCK_H_DEFINED
+#define TRIANGLE_BLOCK_H_DEFINED
+
+#include "quadedge_structure/vertex.h"
+
+class edge;
+
+/*
+* Used as parameter to choose how the triangles of a leaf are tested against a query point
+* scalarScan tests one triangle at a time
+* simdScan tests a whole block at once (4 triangles per instruction with AVX2, 2 with SSE2)
+*/
+enum leafScanMode
+{
+    scalarScan,
+    simdScan
+};
+
+/*
+* Coordinates of 4 triangles stored as structure of arrays, vertices of each triangle are in ccw order
+* Unused lanes hold NaN coordinates, which never contain a point since every comparison with NaN fails
+*/
+struct triangle_block
+{
+    static const int WIDTH = 4;
+    T ax[WIDTH], ay[WIDTH], bx[WIDTH], by[WIDTH], cx[WIDTH], cy[WIDTH];
+
+    triangle_block();
+    void set(int lane, edge* e);
+    void clear(int lane);
+};
+
+// Returns the index (block * WIDTH + lane) of the first triangle that contains p (or has it on its boundary)
+// Returns -1 if no triangle of the blocks contains p
+int findInBlocks(const triangle_block* blocks, int numBlocks, const point &p, leafScanMode mode = simdScan);
+
+#endif
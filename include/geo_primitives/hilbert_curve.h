@@ -0,0 +1,20 @@
+#ifndef HILBERT_CURVE_H_DEFINED
+#define HILBERT_CURVE_H_DEFINED
+
+#include <vector>
+#include <tuple>
+#include <cstddef>
+#include "geo_primitives/point2D.h"
+
+// Returns the position of the cell (x, y) along the Hilbert curve through a 2^32 by 2^32 grid
+unsigned long long hilbertIndex(unsigned int x, unsigned int y);
+
+// Returns the position along the Hilbert curve of p, after mapping the given (left, top, right, bottom) box to the whole grid
+// Points outside the box are clamped to it
+unsigned long long hilbertIndex(const point2D &p, const std::tuple <T, T, T, T> &bounding_box);
+
+// Returns the indices of the points sorted by their position along the Hilbert curve through their bounding box
+// Points that are close along the curve are close in the plane, so consecutive points of the order are mostly near each other
+std::vector <size_t> hilbertOrder(const point2D* points, size_t numPoints);
+
+#endif
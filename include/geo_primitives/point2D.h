@@ -31,6 +31,7 @@ public:
 
     friend bool inSegment(point2D line[2], point2D p);
     friend bool intersects(point2D line1[2], point2D line2[2]);
+    friend bool segmentAbove(const point2D line1[2], const point2D line2[2]);
 
     friend std::istream& operator >> (std::istream&, point2D&);
     friend std::ostream& operator << (std::ostream&, const point2D&);
@@ -0,0 +1,12 @@
+#ifndef PARALLEL_LOCATE_H_DEFINED
+#define PARALLEL_LOCATE_H_DEFINED
+
+#include <cstddef>
+#include "point_location/point_location.h"
+#include "parallel/work_stealing_pool.h"
+
+// Locates points[i] into located[i] for every i < numPoints with all threads of the pool querying the same locator
+// Every thread gets its own query context, the points are split into batches of batchSize that idle threads steal from busy ones
+void locate_parallel(point_location &locator, const point* points, size_t numPoints, edge** located, work_stealing_pool &pool, size_t batchSize = 4096);
+
+#endif
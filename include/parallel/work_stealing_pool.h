@@ -0,0 +1,51 @@
+#ifndef WORK_STEALING_POOL_H_DEFINED
+#define WORK_STEALING_POOL_H_DEFINED
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+/*
+* Fixed set of threads that run the tasks 0, ..., numTasks - 1 of a job
+* Every thread starts with a contiguous range of tasks in its own queue and takes tasks from the back of it
+* A thread whose queue is empty steals from the front of the queues of the other threads, so threads that finish early help the ones that are behind
+* The thread calling run works as thread 0, so a pool of n threads only starts n - 1 of them
+*/
+class work_stealing_pool
+{
+private:
+    struct task_queue
+    {
+        std::mutex lock;
+        std::deque <size_t> tasks;
+    };
+
+    std::vector <std::thread> workers;
+    std::vector <std::unique_ptr <task_queue>> queues;
+    std::function <void(int, size_t)> job;
+
+    std::mutex job_lock;
+    std::condition_variable job_ready, job_done;
+    size_t generation = 0;
+    int numBusy = 0;
+    bool stopping = false;
+
+    bool takeTask(int thread, size_t &task);
+    void work(int thread);
+    void workerLoop(int thread);
+public:
+    // numThreads = 0 uses every hardware thread
+    work_stealing_pool(int numThreads = 0);
+    ~work_stealing_pool();
+
+    // Calls task(thread, i) once for every i < numTasks and returns after all of them are done
+    void run(size_t numTasks, const std::function <void(int, size_t)> &task);
+    int getNumThreads();
+};
+
+#endif
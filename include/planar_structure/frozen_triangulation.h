@@ -0,0 +1,94 @@
+#ifndef FROZEN_TRIANGULATION_H_DEFINED
+#define FROZEN_TRIANGULATION_H_DEFINED
+
+#include <vector>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+#include <exception>
+#include "geo_primitives/point2D.h"
+
+typedef point2D point;
+
+class triangulation;
+
+// Thrown if a buffer or stream given as a snapshot is truncated, corrupted or not a snapshot at all
+struct invalidSnapshotException : std::exception
+{
+    const char * what () const throw ()
+    {
+        return "Invalid Snapshot: Unable to Read Frozen Triangulation";
+    }
+};
+
+/*
+* Read-only snapshot of a triangulation (made by triangulation::freeze) for answering queries without the quadedge structure
+* Triangle t has the vertices vertexIndex(t, 0), vertexIndex(t, 1), vertexIndex(t, 2) in ccw order,
+*      and neighbor(t, i) is the triangle across its edge from vertex i to vertex i + 1 (-1 outside the plane)
+* Every triangle keeps the label of the face it was frozen from, vertices and triangles are numbered along the Hilbert curve so nearby triangles are nearby in memory
+*
+* Everything is stored in one buffer, a header followed by the coordinate, index and label arrays, which is exactly what save writes
+* The buffer holds no pointers, so a saved snapshot can be memory mapped and used in place through the constructor taking a buffer
+* Queries never modify the snapshot, so any number of threads can share one
+*/
+class frozen_triangulation
+{
+friend triangulation;
+private:
+    struct header
+    {
+        char magic[8];
+        int32_t numVertices, numTriangles;
+    };
+
+    std::vector <char> storage; // Empty when the buffer is owned by the caller
+    const header* head = NULL;
+    const T* xs = NULL;
+    const T* ys = NULL;
+    const int32_t* vertices = NULL;
+    const int32_t* neighbors = NULL;
+    const int32_t* labels = NULL;
+
+    frozen_triangulation(const std::vector <T> &xs, const std::vector <T> &ys, const std::vector <int32_t> &vertices,
+                         const std::vector <int32_t> &neighbors, const std::vector <int32_t> &labels);
+
+    static size_t bufferSize(int numVertices, int numTriangles);
+    static bool isValidHeader(const header&);
+    void view(const char*);
+    bool hasValidIndices() const;
+    int startTriangle(point) const;
+public:
+    frozen_triangulation() = default;
+    // The buffer must hold a saved snapshot (aligned to 8 bytes), and stay unchanged for as long as the snapshot is used
+    // Throws invalidSnapshotException if it does not, every index of the buffer is checked once so queries never read outside of it
+    frozen_triangulation(const void* buffer, size_t size);
+    frozen_triangulation(frozen_triangulation&&);
+    frozen_triangulation& operator = (frozen_triangulation&&);
+    frozen_triangulation(const frozen_triangulation&) = delete;
+    frozen_triangulation& operator = (const frozen_triangulation&) = delete;
+
+    // Throws invalidSnapshotException if the stream ends early or does not hold a saved snapshot
+    static frozen_triangulation load(std::istream&);
+    void save(std::ostream&) const;
+
+    int getNumVertices() const;
+    int getNumTriangles() const;
+    point vertexPosition(int v) const;
+    int vertexIndex(int t, int i) const;
+    int neighbor(int t, int i) const;
+    int faceLabel(int t) const;
+
+    /*
+    * Returns the triangle containing p (or having it on its boundary), -1 if p is outside the plane
+    * Walks are remembering stochastic walks (see lawson_oriented_walk), which also work on non-delaunay triangulations
+    * Without a starting triangle, the walk starts at the nearest of a sample of about n^(1/3) triangles
+    */
+    int locate(point) const;
+    int locate(point, int start) const;
+    // Locates points[i] into located[i] for every i < numPoints, in Hilbert order with every walk starting from the previous answer
+    void locate_batch(const point*, size_t, int*) const;
+
+    size_t getMemoryUsage() const;
+};
+
+#endif
@@ -50,7 +50,7 @@ protected:
     edge *incidentEdge = NULL;
 
     static edge* make_polygon(std::vector <vertex*>&, int);
-    static box calculate_LTRB_bounding_box(std::vector <point>&);
+    static box calculate_LTRB_bounding_box(const std::vector <point>&);
 
     edge* init_polygon(const std::vector <point>&);
     edge* init_bounding_box(const box&);
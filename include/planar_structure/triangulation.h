@@ -5,6 +5,7 @@
 #include <vector>
 #include <tuple>
 #include "planar_structure/plane.h"
+#include "planar_structure/frozen_triangulation.h"
 
 /*
 * delaunayTriangulation used to ensure that the minimum angle of the triangulation is maximized and/or ensuring that the circumcircle of every triangle is empty
@@ -17,6 +18,7 @@ enum triangulationType
 };
 
 class edge;
+class point_location;
 class online_point_location;
 class walking_point_location;
 
@@ -25,16 +27,59 @@ class triangulation : public plane
 private:
     edge* init_bounding_box(const box&);
 
-    void fixDelaunayCondition(point, edge*);
+    void fixDelaunayCondition(point, edge*, online_point_location&);
     void addPoint(point, int, online_point_location&, triangulationType);
 
     void init_triangulation(std::vector <point>&, triangulationType, const box& = box{0, 0, 0, 0});
     void init_triangulation(std::vector <point>&, online_point_location&, triangulationType = delaunayTriangulation, const box& = box{0, 0, 0, 0});
+
+    static edge* descendToNearest(edge*, point);
+    static std::vector <vertex*> expandNearest(edge*, point, int);
+    static vertex* nearestPoint(edge*, point);
+    edge* nearestEdge(edge*, point);
+    static std::vector <size_t> locateInHilbertOrder(const point*, size_t, std::vector <edge*>&, point_location&);
+
+    static void floodFillBox(edge*, const box&, const box*, std::vector <edge*>&);
+    bool clipToBounds(box&);
+
+    static edge* walkSegmentFrom(edge*, point, point, std::vector <edge*>&);
 public:
     int numDelaunayFlips = 0;
 
     void generateRandomTriangulation(int numPoints, triangulationType = delaunayTriangulation, const box& = box{-INF, INF, INF, -INF});
     void generateRandomTriangulation(int numPoints, online_point_location&, triangulationType = delaunayTriangulation, const box& = box{-INF, INF, INF, -INF});
+    void generateClusteredTriangulation(int numPoints, int numClusters, triangulationType = delaunayTriangulation, const box& = box{-INF, INF, INF, -INF});
+
+    /*
+    * Nearest neighbor queries among the inserted points, for delaunay triangulations only
+    * The locator must be initialized with this triangulation, its answer is where the search starts
+    * Corners of the bounding box are never returned, NULL (or fewer than k vertices) means that there are not enough points
+    */
+    vertex* nearestVertex(point, point_location&);
+    std::vector <vertex*> kNearest(point, int k, point_location&);
+    void nearestVertex_batch(const point*, size_t, vertex**, point_location&);
+    void kNearest_batch(const point*, size_t, int k, std::vector <vertex*>*, point_location&);
+
+    /*
+    * Range queries, returning an edge of every bounded face that overlaps the closed box (left, top, right, bottom), in no particular order
+    * The locator must be initialized with this triangulation, it locates a corner of the box from which the faces are flood filled
+    * The parallel version splits the box into one vertical strip per thread (numThreads = 0 uses every hardware thread)
+    */
+    std::vector <edge*> faces_in_box(T left, T top, T right, T bottom, point_location&);
+    std::vector <edge*> faces_in_box_parallel(T left, T top, T right, T bottom, point_location&, int numThreads = 0);
+
+    /*
+    * Straight walks, returning the faces crossed by the segment from a to b in order, each given by an edge on it
+    * The first edge is on the face containing a (found with the locator), every following edge is the crossed edge, directed into the face it enters,
+    *      or the edge of the entered face leaving the vertex the segment passes through
+    * A walk stops where the segment leaves the plane, and segments starting outside of the plane cross no faces
+    * walkPolyline walks the segments between consecutive points, each segment starting from the face where the previous one ended
+    */
+    std::vector <edge*> walkSegment(point a, point b, point_location&);
+    void walkPolyline(const point*, size_t, std::vector <edge*>*, point_location&);
+
+    // Returns a read-only snapshot of the triangulation for serving queries (see frozen_triangulation), later changes to the triangulation do not affect it
+    frozen_triangulation freeze();
 
     void read_PT_file(std::istream &is, triangulationType = delaunayTriangulation);
     void write_random_delaunay_triangulation(int numPoints, std::ostream&);
@@ -0,0 +1,50 @@
+#ifndef HILBERT_RTREE_H_DEFINED
+#define HILBERT_RTREE_H_DEFINED
+
+#include <vector>
+#include <tuple>
+#include <cstddef>
+#include "point_location/point_location.h"
+#include "data_structures/triangle_block.h"
+#include "quadedge_structure/vertex.h"
+
+/*
+* Packed Hilbert R-tree over the bounding boxes of the faces, for subdivisions whose face sizes vary a lot
+* Faces are sorted by the position of the center of their bounding box along the Hilbert curve and packed FANOUT at a time into leaves,
+*     then every level packs FANOUT consecutive nodes of the level below into a node, up to a single root
+* Nodes are stored level by level (root first) in one array, child j of node k of a level is node k * FANOUT + j of the next level, so no child pointers are stored
+* Each node holds the boxes of its children as structure of arrays so a query tests all of them at once (4 boxes per instruction with AVX2, 2 with SSE2)
+* Leaves hold the exact coordinates of their triangles in triangle_blocks, unused lanes of nodes and leaves hold NaN and never contain a point
+* Boxes of the same level can overlap, so a query descends into every child whose box contains the point until a leaf triangle contains it
+*/
+class hilbert_rtree : public point_location
+{
+public:
+    static const int FANOUT = 8;
+private:
+    static const int BLOCKS_PER_LEAF = FANOUT / triangle_block::WIDTH;
+    static_assert(FANOUT % triangle_block::WIDTH == 0, "A leaf is made of whole triangle blocks");
+
+    struct node
+    {
+        T left[FANOUT], top[FANOUT], right[FANOUT], bottom[FANOUT];
+
+        node();
+        void set(int lane, const std::tuple <T, T, T, T>&);
+        int contains(const point&) const;
+    };
+
+    std::vector <node> nodes;
+    std::vector <int> level_offsets; // Nodes of level d are nodes[level_offsets[d], level_offsets[d + 1])
+    std::vector <triangle_block> blocks; // Leaf i is blocks[i * BLOCKS_PER_LEAF, (i + 1) * BLOCKS_PER_LEAF)
+    std::vector <edge*> faces; // Triangle i of the leaves is the left face of faces[i]
+public:
+    // Assumes that every bounded face of the plane is a triangle
+    void init(plane&);
+    edge* locate(point);
+
+    std::pair <int, int> getDimensions();
+    size_t getMemoryUsage();
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef KIRKPATRICK_HIERARCHY_H_DEFINED
+#define KIRKPATRICK_HIERARCHY_H_DEFINED
+
+#include <vector>
+#include "point_location/point_location.h"
+#include "quadedge_structure/vertex.h"
+
+class kirkpatrick_hierarchy : public point_location
+{
+private:
+    struct triangle;
+    std::vector <point> vertices;
+    std::vector <triangle> triangles;
+    std::vector <int> children;
+    std::vector <int> roots;
+    int numLevels = 0;
+
+    int MAX_DEGREE;
+
+    bool contains(const triangle&, const point&) const;
+    bool overlaps(const triangle&, const triangle&) const;
+    std::vector <std::vector <int>> triangulatePolygon(std::vector <int>) const;
+    void removeVertex(int, std::vector <std::vector <int>>&, std::vector <bool>&);
+public:
+    kirkpatrick_hierarchy(int degreeBound = 8);
+
+    void init(plane&);
+    edge* locate(point);
+
+    std::pair <int, int> getDimensions();
+};
+
+/*
+* Triangle in some level of the hierarchy, with vertices stored as indices into vertices in ccw order
+* Children are the triangles of the next lower level that overlap this triangle, stored in children[childBegin, childEnd)
+* face is the edge of the original plane whose left face is this triangle (only set for triangles in the lowest level)
+*/
+struct kirkpatrick_hierarchy::triangle
+{
+    int v[3];
+    int childBegin, childEnd;
+    edge* face;
+};
+
+#endif
@@ -2,21 +2,59 @@
 #define NAIVE_QUADTREE_H_DEFINED
 
 #include <vector>
+#include <unordered_set>
 #include "point_location/point_location.h"
 #include "data_structures/quadtree.h"
+#include "data_structures/linear_quadtree.h"
 
-class naive_quadtree : public point_location
+/*
+* Used as parameter to choose how the quadtree of a naive_quadtree is stored
+* pointerQuadtree allocates every node separately and descends through child pointers
+* linearQuadtree stores only the leaves as sorted Morton codes with a flat array of face ids, and descends with one binary search
+*/
+enum quadtreeBackend
+{
+    pointerQuadtree,
+    linearQuadtree
+};
+
+/*
+* Online updates: faces next to an added or removed edge are taken out of the leaves right away, while the edges that are still there are kept as pending
+* applyPendingUpdates (also called by locate, locate_batch and createQueryContext) inserts the current faces of the pending edges, so a batch of edits only reindexes the faces it left behind
+* Both backends update only the leaves that the faces overlap, splitting them like they would be split during construction
+*/
+class naive_quadtree : public online_point_location
 {
 private:
     quadtree root;
+    linear_quadtree linear_root;
+    quadtreeBackend backend;
     int MAX_OVERLAP, MAX_DEPTH;
+    int numThreads;
+    leafScanMode leafScan = simdScan;
+    plane* pln = NULL;
+    std::unordered_set <edge*> pending; // Edges whose left faces are not in the quadtree yet
+
+    void build();
+    void removeFace(edge*);
+    void searchBatch(const point*, size_t, edge**);
 public:
-    naive_quadtree(int overlapBound, int depthBound);
+    // numThreads = 0 uses every hardware thread for construction
+    naive_quadtree(int overlapBound, int depthBound, quadtreeBackend = pointerQuadtree, int threads = 0);
+
+    void setLeafScan(leafScanMode);
 
     void init(plane&);
+    void addEdge(edge*);
+    void removeEdge(edge*);
+    void applyPendingUpdates();
     edge* locate(point);
+    void locate_batch(const point*, size_t, edge**);
+    std::unique_ptr <query_context> createQueryContext();
+    void locate_batch_in_context(const point*, size_t, edge**, query_context*);
 
     std::pair <int, int> getDimensions();
+    size_t getMemoryUsage();
 };
 
 #endif
@@ -0,0 +1,76 @@
+#ifndef PERSISTENT_SLAB_DECOMPOSITION_H_DEFINED
+#define PERSISTENT_SLAB_DECOMPOSITION_H_DEFINED
+
+#include <vector>
+#include <cstddef>
+#include "point_location/point_location.h"
+#include "quadedge_structure/vertex.h"
+
+/*
+* Slab decomposition where the segments of every slab are stored in a persistent treap
+* Consecutive slabs only differ by a few insertions/deletions, so each slab is a version of the treap that shares
+* all unchanged nodes with the previous version instead of being a full copy of the sweep line
+* Versions are kept with node copying: every node has one spare child pointer stamped with the version that set it,
+*      and a node is only copied when that slot is already taken, so each child change costs O(1) amortized nodes
+* Treap updates change O(1) expected child pointers (searching does not change any), so the slabs take O(n) expected space in total
+*/
+class persistent_slab_decomposition : public point_location
+{
+private:
+    struct segment;
+    struct node;
+    struct live_node;
+    std::vector <segment> segments;
+    std::vector <node> nodes;
+    std::vector <T> slab_positions;
+    std::vector <int> versions;
+
+    // Only used during construction, the newest version as an ordinary treap with parent pointers
+    std::vector <live_node> live;
+    int liveRoot = -1;
+    int firstMutableNode = 0;
+
+    bool below(int, int) const;
+    int childAt(int, int, int) const;
+    void link(int, int, int);
+    void record(int, int);
+    void rotateUp(int);
+    void insert(int);
+    void erase(int);
+
+    int findSlabIndex(point);
+    edge* findInSlab(int, point);
+public:
+    void init(plane&);
+    edge* locate(point);
+
+    std::pair <int, int> getDimensions();
+    size_t getMemoryUsage();
+};
+
+// Segment of the plane directed from its left endpoint to its right endpoint, so that its left face is above it
+struct persistent_slab_decomposition::segment
+{
+    point left, right;
+    edge* e;
+};
+
+// Node of the treap, child[0] is below seg and child[1] above it, children are indices into nodes (-1 if empty)
+// child[modSide] is modValue in versions from modVersion on (modSide is -1 while the spare slot is free)
+// Nodes are only modified through the spare slot once they belong to a finished version
+struct persistent_slab_decomposition::node
+{
+    int seg;
+    int child[2];
+    int modSide, modVersion, modValue;
+};
+
+// Node of the newest version, indexed by segment, phys is the node that currently stores it
+struct persistent_slab_decomposition::live_node
+{
+    int child[2];
+    int parent, phys;
+    unsigned int priority;
+};
+
+#endif
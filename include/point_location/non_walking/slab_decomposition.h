@@ -2,20 +2,81 @@
 #define SLAB_DECOMPOSITION_H_DEFINED
 
 #include <vector>
+#include <cstddef>
+#include <unordered_set>
 #include "point_location/point_location.h"
+#include "quadedge_structure/vertex.h"
 
-class slab_decomposition : public point_location
+/*
+* Used as parameter to choose how keys are laid out for the binary searches of a slab decomposition
+* sortedLayout stores keys in sorted order and uses a regular binary search
+* btreeLayout stores keys in the order of an implicit static B-tree with 4 keys per node, so each node is compared in one SIMD instruction
+*/
+enum slabSearchLayout
+{
+    sortedLayout,
+    btreeLayout
+};
+
+/*
+* Segments of every slab are stored in one array, sorted from bottom to top within each slab
+* Slab i owns the segments in [slabs[i].begin, slabs[i].begin + slabs[i].size), followed by free slots it can grow into
+* Each segment keeps its line equation so that its y coordinate at the query x can be computed without touching the edge
+* With btreeLayout, each slab is a static B-tree whose nodes are blocks of 4 line equations (padded with lines at infinity)
+* Online updates are batched: edits only record the x-ranges they touch, and applyPendingUpdates (also called by locate, locate_batch and createQueryContext) sweeps the slabs of those ranges again
+*      (using the segments the slabs already have plus the added edges) and writes them over their old slots, or at the end of the array if they do not fit
+* Every other slab stays where it is, the array is compacted when more than half of it is unused
+*/
+class slab_decomposition : public online_point_location
 {
 private:
     struct event;
-    std::vector <std::vector <edge*>> slabs;
-    std::vector <int> slab_positions;
+    struct line;
+    struct line_block;
+    struct slab_storage;
+    static const int B = 4;
+    static const int BATCH_SIZE = 16; // Number of queries of a batch whose searches run in lockstep
+
+    slabSearchLayout layout;
+    std::vector <line> lines;
+    std::vector <line_block> line_blocks;
+    std::vector <edge*> segments;
+    std::vector <slab_storage> slabs;
+    std::vector <T> slab_positions;
+    std::vector <T> position_tree;
+    std::vector <int> position_indices;
+
+    // Edits since the last query, removed edges are kept in both directions and may already be deleted
+    std::unordered_set <edge*> added_edges, removed_edges;
+    std::vector <std::pair <T, T>> dirty_ranges;
+
+    static std::vector <int> btreeOrder(int);
+    void addSlab(const std::vector <edge*>&);
+    void sweepSlabs(const std::vector <edge*>&, const std::vector <T>&);
+    void buildPositionTree();
+    void resizeStorage(size_t);
+    void moveSlots(size_t, size_t, size_t);
+    void compactStorage();
 
     int findSlabIndex(point);
     edge* findInSlab(int, point);
+    void findSlabIndices(const point*, int, int*);
+    void findInSlabs(const point*, int, const int*, edge**);
+    void searchBatch(const point*, size_t, edge**);
 public:
+    slab_decomposition(slabSearchLayout = sortedLayout);
+
     void init(plane&);
+    void addEdge(edge*);
+    void removeEdge(edge*);
+    void applyPendingUpdates();
     edge* locate(point);
+    void locate_batch(const point*, size_t, edge**);
+    std::unique_ptr <query_context> createQueryContext();
+    void locate_batch_in_context(const point*, size_t, edge**, query_context*);
+
+    std::pair <int, size_t> getDimensions();
+    size_t getMemoryUsage();
 };
 
 struct slab_decomposition::event
@@ -27,4 +88,24 @@ struct slab_decomposition::event
     bool operator < (const event&) const;
 };
 
+// Line through a non-vertical segment, y = slope * x + intercept
+struct slab_decomposition::line
+{
+    T slope, intercept;
+
+    T y(T x) const {return slope * x + intercept;}
+};
+
+// Node of a static B-tree of lines, stored as structure of arrays so that all 4 heights are computed at once
+struct slab_decomposition::line_block
+{
+    T slope[B], intercept[B];
+};
+
+// Slots of a slab in the segment array, the slots in [begin + size, begin + capacity) are free
+struct slab_decomposition::slab_storage
+{
+    size_t begin, size, capacity;
+};
+
 #endif
@@ -0,0 +1,74 @@
+#ifndef TRAPEZOIDAL_MAP_H_DEFINED
+#define TRAPEZOIDAL_MAP_H_DEFINED
+
+#include <vector>
+#include <cstddef>
+#include "point_location/point_location.h"
+#include "quadedge_structure/vertex.h"
+
+/*
+* Used to tag nodes of the search structure
+* xNode splits by the x coordinate of a point (ties broken by y coordinate)
+* yNode splits by whether a point is above or below a segment
+* leafNode represents a trapezoid of the current map
+*/
+enum trapezoidalNodeType
+{
+    xNode,
+    yNode,
+    leafNode
+};
+
+class trapezoidal_map : public point_location
+{
+private:
+    struct segment;
+    struct trapezoid;
+    struct node;
+    std::vector <segment> segments;
+    std::vector <trapezoid> trapezoids;
+    std::vector <node> nodes;
+    std::vector <int> lastVisited; // Only used during construction to avoid visiting a node twice
+
+    point endpoint(int) const;
+    static bool isAbove(const segment&, const segment&);
+    static edge* boundedSide(const segment&);
+    std::vector <int> crossedTrapezoids(int);
+    void insertSegment(int);
+public:
+    void init(plane&);
+    edge* locate(point);
+
+    std::pair <int, int> getDimensions();
+    size_t getMemoryUsage();
+};
+
+// Segment of the plane directed from its lexicographically smaller endpoint to its larger one, so that its left face is above it
+struct trapezoidal_map::segment
+{
+    point left, right;
+    edge* e;
+};
+
+// Top and bottom are indices of the bounding segments (-1 if unbounded)
+// leftp and rightp are the points that define the vertical walls of the trapezoid
+struct trapezoidal_map::trapezoid
+{
+    int top, bottom;
+    point leftp, rightp;
+    int leaf;
+};
+
+/*
+* For xNodes, index / 2 refers to a segment and index % 2 picks its left (0) or right (1) endpoint, child[0] is left of that point and child[1] is right of it
+* For yNodes, index refers to a segment, child[0] is above it and child[1] is below it
+* For leafNodes, index refers to a trapezoid
+*/
+struct trapezoidal_map::node
+{
+    trapezoidalNodeType type;
+    int index;
+    int child[2];
+};
+
+#endif
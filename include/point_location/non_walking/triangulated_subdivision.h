@@ -0,0 +1,40 @@
+#ifndef TRIANGULATED_SUBDIVISION_H_DEFINED
+#define TRIANGULATED_SUBDIVISION_H_DEFINED
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstddef>
+#include "point_location/point_location.h"
+
+/*
+* Locator for subdivisions whose faces are simple polygons of any size, convex or not
+* Every bounded face is split into triangles by ear clipping, and the triangles form a hidden plane that the given locator is built on
+* Triangles of the hidden plane map back to an edge of the face they were clipped from, so answers are given in the original subdivision
+* Any locator works on the hidden plane, but walks also need the union of the faces to be convex
+*/
+class triangulated_subdivision : public point_location
+{
+private:
+    struct hidden_plane;
+    std::unique_ptr <point_location> locator;
+    std::unique_ptr <hidden_plane> triangles;
+    std::vector <edge*> triangle_faces; // Triangle i of the hidden plane (with face label i + 1) was clipped from the left face of triangle_faces[i]
+    std::unordered_map <long long, edge*> subdivision_edges; // Edges of the subdivision by the indices of their endpoints
+
+    static void clipEars(const std::vector <point>&, const std::vector <int>&, std::vector <std::vector <int>>&);
+    edge* originalFace(edge*);
+    edge* originalEdge(edge*);
+public:
+    triangulated_subdivision(std::unique_ptr <point_location>&);
+    ~triangulated_subdivision();
+
+    void init(plane&);
+    edge* locate(point);
+    location locate_ex(point);
+    void locate_batch(const point*, size_t, edge**);
+
+    int getNumTriangles();
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef UNIFORM_GRID_H_DEFINED
+#define UNIFORM_GRID_H_DEFINED
+
+#include <vector>
+#include <tuple>
+#include <cstddef>
+#include "point_location/point_location.h"
+#include "point_location/walking/lawson_oriented_walk.h"
+#include "data_structures/triangle_block.h"
+#include "quadedge_structure/vertex.h"
+
+/*
+* Used as parameter to choose which faces are stored in each cell of a uniform grid
+* overlappingFaces stores every face that overlaps a cell, so the face containing a query point is always in its cell
+* centroidFaces stores each face only in the cell containing its centroid, using one reference per face
+*     queries that do not find their face in their cell (always the case for empty cells) walk from a nearby face instead
+*/
+enum gridCellContents
+{
+    overlappingFaces,
+    centroidFaces
+};
+
+/*
+* Uniform grid over the bounds of the plane with about cellsPerFace cells per face
+* Faces of cell i are stored as indices into faces in face_ids[cell_offsets[i], cell_offsets[i + 1])
+* Each cell is padded to a multiple of 4 slots (with id -1) and slot j also has its coordinates in lane j % 4 of blocks[j / 4]
+*/
+class uniform_grid : public point_location
+{
+private:
+    struct grid_context;
+    std::vector <int> cell_offsets;
+    std::vector <int> face_ids;
+    std::vector <triangle_block> blocks;
+    std::vector <edge*> faces;
+    std::vector <int> start_faces; // Only used with centroidFaces, face to walk from for every cell
+    T left, top, right, bottom, cell_width, cell_height;
+    int numColumns = 0, numRows = 0;
+
+    lawson_oriented_walk walker;
+
+    double CELLS_PER_FACE;
+    gridCellContents contents;
+    int numThreads;
+
+    int columnOf(T x) const;
+    int rowOf(T y) const;
+    std::tuple <T, T, T, T> cellBounds(int column, int row) const;
+    void computeStartFaces();
+    edge* locate(point, lawson_oriented_walk&);
+public:
+    // numThreads = 0 uses every hardware thread for construction
+    uniform_grid(double cellsPerFace = 1.0, gridCellContents = overlappingFaces, int threads = 0);
+
+    void init(plane&);
+    edge* locate(point);
+
+    std::unique_ptr <query_context> createQueryContext();
+    void locate_batch_in_context(const point*, size_t, edge**, query_context*);
+
+    std::pair <int, int> getDimensions();
+    size_t getMemoryUsage();
+};
+
+// Walks from the start faces of centroidFaces grids use their own copy of the walk
+struct uniform_grid::grid_context : public query_context
+{
+    lawson_oriented_walk walker;
+};
+
+#endif
@@ -1,17 +1,83 @@
 #ifndef POINT_LOCATION_H_DEFINED
 #define POINT_LOCATION_H_DEFINED
 
-class point2D;
+#include <cstddef>
+#include <memory>
+#include <exception>
+#include "geo_primitives/point2D.h"
+
 typedef point2D point;
 class edge;
 class plane;
 
+/*
+* Used to tag where a located point lies with respect to the edge returned along with it
+* inFace: strictly inside the left face of the edge
+* onEdge: on the edge, strictly between its endpoints
+* onVertex: at the origin of the edge
+* outsidePlane: outside the plane, the edge is NULL
+*/
+enum locationType
+{
+    inFace,
+    onEdge,
+    onVertex,
+    outsidePlane
+};
+
+struct location
+{
+    locationType type;
+    edge* e;
+};
+
+// Tags p given any edge of a face that contains it (NULL if p is outside the plane) by testing p against every edge of the face
+location classifyLocation(edge*, point);
+
+/*
+* State that queries are allowed to modify, every thread querying a shared locator needs its own
+* Locators extend it with whatever their queries write to (like the counters and random generator of a walk)
+*/
+class query_context
+{
+public:
+    virtual ~query_context() = default;
+};
+
 class point_location
 {
 public:
     virtual ~point_location() = default;
     virtual void init(plane&) = 0;
     virtual edge* locate(point) = 0;
+
+    // Same as locate, but also tells whether p lies inside the face, on an edge or on a vertex
+    // Locators override this to tag the result with the orientation tests that their queries already made
+    virtual location locate_ex(point p)
+    {
+        return classifyLocation(locate(p), p);
+    }
+
+    // Locates points[i] into located[i] for every i < numPoints
+    // Locators override this to overlap the memory accesses of neighboring queries or to reuse state between them
+    virtual void locate_batch(const point* points, size_t numPoints, edge** located)
+    {
+        for (size_t i = 0; i < numPoints; i++)
+            located[i] = locate(points[i]);
+    }
+
+    // Returns the state one thread needs to query this locator alongside other threads
+    // Returns NULL for locators whose queries only read the locator
+    virtual std::unique_ptr <query_context> createQueryContext()
+    {
+        return nullptr;
+    }
+
+    // Same as locate_batch, but queries only modify the given context (created by createQueryContext), so threads with different contexts can run it at the same time
+    virtual void locate_batch_in_context(const point* points, size_t numPoints, edge** located, query_context*)
+    {
+        locate_batch(points, numPoints, located);
+    }
 };
 
 class walking_scheme
@@ -19,13 +85,46 @@ class walking_scheme
 public:
     virtual ~walking_scheme() = default;
     virtual edge* locate(edge*, point) = 0;
+
+    // Same as locate, with the result tagged as in point_location::locate_ex
+    virtual location locate_ex(edge* startEdge, point p)
+    {
+        return classifyLocation(locate(startEdge, p), p);
+    }
+
+    // Walks to points[i] from startEdges[i] into located[i] for every i < numPoints
+    // Walking schemes override this to overlap the memory accesses of independent walks
+    virtual void locate_batch(edge* const* startEdges, const point* points, size_t numPoints, edge** located)
+    {
+        for (size_t i = 0; i < numPoints; i++)
+            located[i] = locate(startEdges[i], points[i]);
+    }
+
+    // Returns a copy with its own counters and random state, for walks on another thread
+    virtual std::unique_ptr <walking_scheme> clone() const = 0;
+};
+
+// Thrown if an online locator is queried through a query context while it has edits that were not applied yet
+struct pendingUpdatesException : std::exception
+{
+    const char * what () const throw ()
+    {
+        return "Pending Updates: Edits Must Be Applied Before Querying From Several Threads";
+    }
 };
 
+/*
+* Locators that follow edits of the plane they were initialized with
+* Locators may only record edits in addEdge and removeEdge, applyPendingUpdates brings their index up to date
+* locate and locate_batch apply pending edits first, locate_batch_in_context (which threads run at the same time) throws pendingUpdatesException instead
+* createQueryContext applies pending edits, so contexts made before the threads start (like in locate_parallel) never see any
+*/
 class online_point_location : public point_location
 {
 public:
     virtual void addEdge(edge*) = 0;
     virtual void removeEdge(edge*) = 0;
+    virtual void applyPendingUpdates() {}
 };
 
 #endif
@@ -3,27 +3,35 @@
 
 #include <vector>
 #include "point_location/point_location.h"
+#include "point_location/walking/lawson_walk.h"
 
 enum lawsonWalkOptions
 {
     stochasticWalk,
     rememberingWalk,
     fastRememberingWalk,
+    lockstepWalk,
 };
 
 class lawson_oriented_walk : public walking_scheme
 {
 private:
-    bool isStochastic = false, isRemembering = false, isFast = false;
+    bool isStochastic = false, isRemembering = false, isFast = false, isLockstep = false;
     unsigned int maxFastSteps = 0;
+    int interleaveWidth = 1;
+    xorshift_rng rng;
 public:
     int numTests = 0, numFaces = 0;
 
     lawson_oriented_walk(){}
     lawson_oriented_walk(const std::vector <lawsonWalkOptions>&, unsigned int = 0);
     void setParameters(const std::vector <lawsonWalkOptions>& = {}, unsigned int = 0);
+    void setInterleaveWidth(int);
 
     edge* locate(edge*, point);
+    location locate_ex(edge*, point);
+    void locate_batch(edge* const*, const point*, size_t, edge**);
+    std::unique_ptr <walking_scheme> clone() const;
 };
 
 #endif
@@ -0,0 +1,261 @@
+#ifndef LAWSON_WALK_H_DEFINED
+#define LAWSON_WALK_H_DEFINED
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "point_location/point_location.h"
+#include "quadedge_structure/edge.h"
+
+// Xorshift generator, small enough to give every walk its own state
+struct xorshift_rng
+{
+    uint32_t state;
+
+    explicit xorshift_rng(uint32_t seed = 2463534242u) : state(seed ? seed : 2463534242u) {}
+    uint32_t next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+};
+
+// Position of a walk between two steps
+struct lawson_walk_state
+{
+    edge* currEdge;
+    unsigned int fastStepsLeft;
+    bool firstIteration;
+    // Number of links of the current face that have been prefetched (see lawson_walk_prefetch)
+    int prefetched;
+    // Edges of the last face scanned whose lines pass through the query point
+    int numOnEdges = 0;
+    edge* onEdges[2] = {};
+};
+
+/*
+* Lawsons oriented walk with its options fixed at compile time (see lawson_oriented_walk for what each option does)
+* A stochastic walk starts scanning the edges of each face at a random edge, which is enough to break the loops of non-delaunay triangulations
+* Walks never allocate, faces are scanned in place by following fnext
+* Advances the walk by one face and returns true once it is done, in which case currEdge is the answer (NULL if p is outside the plane)
+*/
+template <bool isStochastic, bool isRemembering, bool isFast>
+inline bool lawson_walk_step(lawson_walk_state &walk, const point &p, xorshift_rng &rng, int &numTests, int &numFaces)
+{
+    static_assert(isRemembering or !isFast, "A fast walk is always a remembering walk");
+
+    if (isFast and walk.fastStepsLeft > 0)
+    {
+        // A fast remembering walk assumes that the current face is not the target face and that plane is a triangulation
+        // Only use this for the first fastSteps steps so that the target face is detected eventually
+        walk.fastStepsLeft--;
+        edge* e1 = walk.currEdge -> fnext();
+        edge* e2 = e1 -> fnext();
+        numTests++;
+        // If assumption is valid, then if e1 does not make a right turn, then e2 must make a right turn
+        edge* candidate = orientation(e1 -> originPosition(), e1 -> destinationPosition(), p) > 0 ? e1 -> twin() : e2 -> twin();
+        numFaces++;
+        // If candidate is a boundary edge, point p might be outside the plane or the assumption that the current face is not the target face might be incorrect
+        // End the fast portion of the fast remembering walk and let the regular walk determine which case is valid
+        if (candidate -> rightfaceLabel() == 0)
+            walk.fastStepsLeft = 0;
+        else
+            walk.currEdge = candidate;
+        return false;
+    }
+
+    walk.numOnEdges = 0;
+    edge* first = walk.currEdge;
+    if (isStochastic)
+    {
+        int faceSize = 1;
+        for (edge* e = walk.currEdge -> fnext(); e != walk.currEdge; e = e -> fnext())
+            faceSize++;
+        for (uint32_t skip = rng.next() % faceSize; skip > 0; skip--)
+            first = first -> fnext();
+    }
+
+    edge* e = first;
+    do
+    {
+        // In a remembering walk, the common edge between the current and previous faces is skipped
+        if (!(isRemembering and !walk.firstIteration and e == walk.currEdge))
+        {
+            numTests++;
+            T o = orientation(e -> originPosition(), e -> destinationPosition(), p);
+            // If p is to the right of e, go to the twin edge on the right face of e
+            if (o > 0)
+            {
+                numFaces++;
+                if (e -> rightfaceLabel() == 0)
+                {
+                    walk.currEdge = NULL;
+                    return true;
+                }
+                walk.currEdge = e -> twin();
+                walk.firstIteration = false;
+                return false;
+            }
+            if (o == 0 and walk.numOnEdges < 2)
+                walk.onEdges[walk.numOnEdges++] = e;
+        }
+        e = e -> fnext();
+    } while (e != first);
+    numFaces++;
+
+    // If no right turns are made from the face edges to point p, then p must be inside the face
+    return true;
+}
+
+template <bool isStochastic, bool isRemembering, bool isFast>
+edge* lawson_walk_locate(edge* startEdge, point p, unsigned int maxFastSteps, xorshift_rng &rng, int &numTests, int &numFaces)
+{
+    lawson_walk_state walk{startEdge, maxFastSteps, true, 0};
+    while (!lawson_walk_step<isStochastic, isRemembering, isFast>(walk, p, rng, numTests, numFaces));
+    return walk.currEdge;
+}
+
+/*
+* Tags the result of a finished walk with the orientation tests of its last face
+* The edge a remembering walk skips is never one that p lies on, since p was strictly to the right of its twin
+* In a triangle, p is on the lines of two edges only at their common vertex
+* Larger faces can have collinear consecutive edges, so their tags come from classifyLocation instead
+*/
+inline location lawson_walk_location(const lawson_walk_state &walk, const point &p)
+{
+    if (walk.currEdge == NULL)
+        return {outsidePlane, NULL};
+    if (walk.currEdge -> fnext() -> fnext() -> fnext() != walk.currEdge)
+        return classifyLocation(walk.currEdge, p);
+    if (walk.numOnEdges == 0)
+        return {inFace, walk.currEdge};
+    if (walk.numOnEdges == 1)
+        return {onEdge, walk.onEdges[0]};
+    edge* a = walk.onEdges[0];
+    edge* b = walk.onEdges[1];
+    return {onVertex, a -> fnext() == b ? b : a};
+}
+
+template <bool isStochastic, bool isRemembering, bool isFast>
+location lawson_walk_locate_ex(edge* startEdge, point p, unsigned int maxFastSteps, xorshift_rng &rng, int &numTests, int &numFaces)
+{
+    lawson_walk_state walk{startEdge, maxFastSteps, true, 0};
+    while (!lawson_walk_step<isStochastic, isRemembering, isFast>(walk, p, rng, numTests, numFaces));
+    return lawson_walk_location(walk, p);
+}
+
+/*
+* Requests the next loads that the next step of a walk makes, without waiting for them
+* Reaching the first edges of a face is a chain of dependent loads (fnext is invrot, onext, rot), so the chain is prefetched one link per call,
+*      every call only reading what the previous call prefetched
+* Returns true once the whole chain is prefetched, after which the step can start without waiting on it
+*/
+inline bool lawson_walk_prefetch(lawson_walk_state &walk)
+{
+    edge* e = walk.currEdge;
+    switch (walk.prefetched++)
+    {
+        case 0:
+            __builtin_prefetch(e);
+            return false;
+        case 1:
+            __builtin_prefetch(e -> invrot());
+            __builtin_prefetch(e -> twin());
+            __builtin_prefetch(&e -> origin());
+            return false;
+        case 2:
+            __builtin_prefetch(e -> invrot() -> onext());
+            __builtin_prefetch(&e -> destination());
+            return false;
+        case 3:
+            __builtin_prefetch(e -> fnext());
+            return false;
+        default:
+            return true;
+    }
+}
+
+/*
+* Walks to points[i] from startEdges[i] for every i < numPoints, keeping up to width walks in progress
+* Walks in progress take turns, on each turn a walk either prefetches the next link of its current face (see lawson_walk_prefetch) or, once the face is prefetched, advances by a single face
+* By the time a walk gets its next turn the loads it requested are done, so the cache misses of all walks in progress overlap instead of adding up
+* Widths above 64 are treated as 64
+*/
+template <bool isStochastic, bool isRemembering, bool isFast>
+void lawson_walk_interleaved(edge* const* startEdges, const point* points, size_t numPoints, edge** located, int width,
+                             unsigned int maxFastSteps, xorshift_rng &rng, int &numTests, int &numFaces)
+{
+    const int MAX_WIDTH = 64;
+    width = std::max(1, std::min(width, MAX_WIDTH));
+    lawson_walk_state walks[MAX_WIDTH];
+    size_t query[MAX_WIDTH];
+    int numWalks = 0;
+    size_t nextQuery = 0;
+    while (true)
+    {
+        // Walks that finished in the previous round are replaced by walks to the next points
+        for (; numWalks < width and nextQuery < numPoints; numWalks++, nextQuery++)
+        {
+            walks[numWalks] = {startEdges[nextQuery], maxFastSteps, true, 0};
+            query[numWalks] = nextQuery;
+        }
+        if (numWalks == 0) break;
+
+        for (int i = 0; i < numWalks; )
+        {
+            if (!lawson_walk_prefetch(walks[i]))
+            {
+                i++;
+                continue;
+            }
+            walks[i].prefetched = 0;
+            if (lawson_walk_step<isStochastic, isRemembering, isFast>(walks[i], points[query[i]], rng, numTests, numFaces))
+            {
+                located[query[i]] = walks[i].currEdge;
+                // The last walk takes the place of the finished one and gets its turn in this round
+                numWalks--;
+                walks[i] = walks[numWalks];
+                query[i] = query[numWalks];
+            }
+            else
+                i++;
+        }
+    }
+}
+
+// Fast remembering walks advanced in SIMD lanes, only for triangulations (defined in lawson_walk_lockstep.cpp)
+void lawson_walk_lockstep(edge* const* startEdges, const point* points, size_t numPoints, edge** located,
+                          unsigned int maxFastSteps, int &numTests, int &numFaces);
+
+// Walking scheme for a single combination of options, usable wherever a walking_scheme is expected
+template <bool isStochastic, bool isRemembering, bool isFast>
+class lawson_walk : public walking_scheme
+{
+private:
+    unsigned int maxFastSteps;
+    xorshift_rng rng;
+public:
+    int numTests = 0, numFaces = 0;
+
+    // Iff not a fast walk, fastSteps should be 0
+    lawson_walk(unsigned int fastSteps = 0, uint32_t seed = 2463534242u) : maxFastSteps(fastSteps), rng(seed) {}
+
+    edge* locate(edge* startEdge, point p)
+    {
+        return lawson_walk_locate<isStochastic, isRemembering, isFast>(startEdge, p, maxFastSteps, rng, numTests, numFaces);
+    }
+
+    location locate_ex(edge* startEdge, point p)
+    {
+        return lawson_walk_locate_ex<isStochastic, isRemembering, isFast>(startEdge, p, maxFastSteps, rng, numTests, numFaces);
+    }
+
+    std::unique_ptr <walking_scheme> clone() const
+    {
+        return std::make_unique<lawson_walk>(*this);
+    }
+};
+
+#endif
@@ -3,17 +3,28 @@
 
 #include <vector>
 #include <unordered_set>
+#include <random>
+#include <ctime>
+#include <cstddef>
+#include "geo_primitives/point2D.h"
 
-class point2D;
 typedef point2D point;
 class edge;
 class plane;
 
+/*
+* Used as parameter to choose the edge that a walk starts from
+* selectFirst starts from an arbitrary edge of the plane
+* selectRecent starts from the edge returned by the previous walk
+* selectSample starts from the edge closest to the query point out of sampleSize random edges
+* selectGrid starts from an edge incident to a vertex in the grid cell of the query point (or a nearby cell if it has none)
+*/
 enum selectorMode
 {
     selectFirst,
     selectRecent,
-    selectSample
+    selectSample,
+    selectGrid
 };
 
 class starting_edge_selector
@@ -22,8 +33,23 @@ private:
     edge *recentEdge = NULL;
     std::vector <edge*> edgeList;
     std::unordered_set <edge*> validEdges;
+    std::mt19937 gen{static_cast<unsigned int>(time(0))};
 
-    edge* bestFromSample(point);
+    // Only used with selectGrid, cell i holds some edge whose origin lies in it (NULL if it has none)
+    std::vector <edge*> grid;
+    T gridLeft = 0, gridBottom = 0, gridWidth = 0, gridHeight = 0;
+    int gridColumns = 0, gridRows = 0;
+
+    // The grid is refined once it holds more than GRID_EDGES_PER_CELL edges per cell on average
+    static const int GRID_EDGES_PER_CELL = 8;
+
+    edge* bestFromSample(point, std::mt19937&) const;
+
+    int gridCell(point) const;
+    void resizeGrid(int, int);
+    void addToGrid(edge*);
+    void removeFromGrid(edge*);
+    edge* nearestFromGrid(point) const;
 public:
     selectorMode mode = selectFirst;
     unsigned int sampleSize = 0;
@@ -38,6 +64,8 @@ public:
     void locatedEdge(edge*);
 
     edge* getStartingEdge(point p);
+    // Only reads the selector, the most recently located edge and the random generator are given by the caller (one per thread)
+    edge* getStartingEdge(point p, edge* recent, std::mt19937 &generator) const;
 };
 
 #endif
@@ -4,19 +4,62 @@
 #include "point_location/point_location.h"
 #include "point_location/walking/starting_edge_selector.h"
 #include <memory>
+#include <functional>
+
+/*
+* Used as parameter to choose the order in which a batch of queries is walked to
+* givenOrder walks to the points in the order they are given
+* hilbertSortedOrder walks to the points sorted along a Hilbert curve, so consecutive walks are short, and writes each answer back to the position of its point
+*/
+enum batchWalkOrder
+{
+    givenOrder,
+    hilbertSortedOrder
+};
+
+/*
+* Used as parameter to choose where the walks of a batch start
+* previousAnswerStarts starts each walk from the starting edge selector or from the answer to the previous query, whichever is closer, so walks run one after the other
+* selectorStarts starts every walk from the starting edge selector, so all walks are known up front and the walking scheme can interleave them
+*/
+enum batchWalkStarts
+{
+    previousAnswerStarts,
+    selectorStarts
+};
 
 class walking_point_location : public online_point_location
 {
 private:
+    struct walking_context;
     std::unique_ptr <walking_scheme> locator;
     std::unique_ptr <starting_edge_selector> selector;
+    batchWalkOrder batchOrder = givenOrder;
+    batchWalkStarts batchStarts = previousAnswerStarts;
+
+    void walkBatch(const point*, size_t, edge**, walking_scheme&, const std::function <edge*(point)>&, const std::function <void(edge*)>&);
 public:
     walking_point_location(std::unique_ptr<walking_scheme>&, std::unique_ptr<starting_edge_selector>&);
+    void setBatchOrder(batchWalkOrder);
+    void setBatchStarts(batchWalkStarts);
 
     void init(plane&);
     void addEdge(edge*);
     void removeEdge(edge*);
     edge* locate(point);
+    location locate_ex(point);
+    void locate_batch(const point*, size_t, edge**);
+
+    std::unique_ptr <query_context> createQueryContext();
+    void locate_batch_in_context(const point*, size_t, edge**, query_context*);
+};
+
+// Everything that walks write to: a copy of the walking scheme, the last edge found and the generator of sampled starting edges
+struct walking_point_location::walking_context : public query_context
+{
+    std::unique_ptr <walking_scheme> walker;
+    edge* recentEdge = NULL;
+    std::mt19937 generator;
 };
 
 #endif
@@ -37,6 +37,11 @@ void print_time(const std::string &name)
     std::cout << "Time taken for " << name << ": " << ((duration_type) (end_time - start_time)).count() << " s" << std::endl;
 }
 
+void print_throughput(const std::string &name, int numQueries, double t)
+{
+    std::cout << "Throughput of " << name << ": " << numQueries / t << " queries/s" << std::endl;
+}
+
 void print_percent_correct(const std::string &name, int correct, int total)
 {
     double percentage = (double) (correct * 100) / total;
@@ -0,0 +1,46 @@
+#include "clustered_point_rng.h"
+#include "uniform_point_rng.h"
+#include <assert.h>
+#include <ctime>
+
+clustered_point_rng::clustered_point_rng(const std::tuple <T, T, T, T> &LTRB, int numClusters, T relativeSpread) : clustered_point_rng(std::get<0>(LTRB), std::get<1>(LTRB), std::get<2>(LTRB), std::get<3>(LTRB), numClusters, relativeSpread) {}
+
+// Cluster centers are picked uniformly inside the box
+// Each cluster is a normal distribution whose standard deviation is relativeSpread times the box dimensions
+clustered_point_rng::clustered_point_rng(T left, T top, T right, T bottom, int numClusters, T relativeSpread)
+{
+    assert(left <= right and bottom <= top and numClusters > 0);
+    gen = std::mt19937{static_cast<unsigned int>(time(0))};
+    dist = std::normal_distribution<T>(0.0, 1.0);
+    clusterDist = std::uniform_int_distribution<int>(0, numClusters - 1);
+    minValue[0] = left, maxValue[0] = right;
+    minValue[1] = bottom, maxValue[1] = top;
+    for (int i = 0; i < 2; i++)
+    {
+        spread[i] = relativeSpread * (maxValue[i] - minValue[i]);
+    }
+    uniform_point_rng centerRng(left, top, right, bottom);
+    centers = centerRng.getRandom(numClusters);
+}
+
+// Points that fall outside the box are rejected so that every point stays inside [left, right] x [bottom, top]
+point clustered_point_rng::getRandom()
+{
+    while (true)
+    {
+        const point &center = centers[clusterDist(gen)];
+        point p(center.x + spread[0] * dist(gen), center.y + spread[1] * dist(gen));
+        if (p.x >= minValue[0] and p.x <= maxValue[0] and p.y >= minValue[1] and p.y <= maxValue[1])
+            return p;
+    }
+}
+
+std::vector <point> clustered_point_rng::getRandom(int numPoints)
+{
+    std::vector <point> result(numPoints);
+    for (int i = 0; i < numPoints; i++)
+    {
+        result[i] = getRandom();
+    }
+    return result;
+}
@@ -0,0 +1,248 @@
+#include "planar_structure/frozen_triangulation.h"
+#include "point_location/walking/lawson_walk.h"
+#include "geo_primitives/hilbert_curve.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <assert.h>
+
+namespace
+{
+    const char MAGIC[8] = {'F', 'R', 'O', 'Z', 'E', 'N', 'T', '1'};
+
+    // Number of bytes load reads at a time, so a truncated stream is noticed before the whole size claimed by its header is allocated
+    const size_t LOAD_CHUNK_SIZE = 1 << 20;
+}
+
+/* Storage */
+
+// Header, then x and y coordinates of the vertices, then vertex indices, neighbor indices and labels of the triangles
+// Coordinates come right after the 16 byte header, so every array is aligned to the size of its elements
+size_t frozen_triangulation::bufferSize(int numVertices, int numTriangles)
+{
+    return sizeof(header) + 2 * (size_t) numVertices * sizeof(T) + 7 * (size_t) numTriangles * sizeof(int32_t);
+}
+
+bool frozen_triangulation::isValidHeader(const header &h)
+{
+    return std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 and h.numVertices >= 0 and h.numTriangles >= 0;
+}
+
+// Points the arrays into the given buffer, which starts with a valid header
+void frozen_triangulation::view(const char* buffer)
+{
+    head = reinterpret_cast<const header*>(buffer);
+    xs = reinterpret_cast<const T*>(buffer + sizeof(header));
+    ys = xs + head -> numVertices;
+    vertices = reinterpret_cast<const int32_t*>(ys + head -> numVertices);
+    neighbors = vertices + 3 * head -> numTriangles;
+    labels = neighbors + 3 * head -> numTriangles;
+}
+
+// Checks that every triangle refers to existing vertices and to existing neighbors (or to -1)
+bool frozen_triangulation::hasValidIndices() const
+{
+    int numVertices = getNumVertices(), numTriangles = getNumTriangles();
+    for (size_t i = 0; i < 3 * (size_t) numTriangles; i++)
+    {
+        if (vertices[i] < 0 or vertices[i] >= numVertices or neighbors[i] < -1 or neighbors[i] >= numTriangles)
+            return false;
+    }
+    return true;
+}
+
+frozen_triangulation::frozen_triangulation(const std::vector <T> &x, const std::vector <T> &y, const std::vector <int32_t> &triangle_vertices,
+                                           const std::vector <int32_t> &triangle_neighbors, const std::vector <int32_t> &triangle_labels)
+{
+    assert(x.size() == y.size() and triangle_vertices.size() == 3 * triangle_labels.size() and triangle_neighbors.size() == 3 * triangle_labels.size());
+    header h;
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.numVertices = x.size();
+    h.numTriangles = triangle_labels.size();
+
+    storage.resize(bufferSize(h.numVertices, h.numTriangles));
+    char* out = storage.data();
+    auto append = [&](const void* data, size_t numBytes)
+    {
+        std::memcpy(out, data, numBytes);
+        out += numBytes;
+    };
+    append(&h, sizeof(header));
+    append(x.data(), x.size() * sizeof(T));
+    append(y.data(), y.size() * sizeof(T));
+    append(triangle_vertices.data(), triangle_vertices.size() * sizeof(int32_t));
+    append(triangle_neighbors.data(), triangle_neighbors.size() * sizeof(int32_t));
+    append(triangle_labels.data(), triangle_labels.size() * sizeof(int32_t));
+    view(storage.data());
+}
+
+frozen_triangulation::frozen_triangulation(const void* buffer, size_t size)
+{
+    const char* bytes = static_cast<const char*>(buffer);
+    // Make sure that the buffer holds a saved snapshot and that its coordinates are aligned
+    if (size < sizeof(header) or reinterpret_cast<uintptr_t>(bytes) % alignof(T) != 0)
+        throw invalidSnapshotException();
+    const header &h = *reinterpret_cast<const header*>(bytes);
+    if (!isValidHeader(h) or size != bufferSize(h.numVertices, h.numTriangles))
+        throw invalidSnapshotException();
+    view(bytes);
+    if (!hasValidIndices())
+        throw invalidSnapshotException();
+}
+
+// The arrays point into the heap buffer of storage, which moves along with it
+frozen_triangulation::frozen_triangulation(frozen_triangulation &&other)
+{
+    *this = std::move(other);
+}
+
+frozen_triangulation& frozen_triangulation::operator = (frozen_triangulation &&other)
+{
+    storage = std::move(other.storage);
+    head = std::exchange(other.head, nullptr);
+    xs = std::exchange(other.xs, nullptr);
+    ys = std::exchange(other.ys, nullptr);
+    vertices = std::exchange(other.vertices, nullptr);
+    neighbors = std::exchange(other.neighbors, nullptr);
+    labels = std::exchange(other.labels, nullptr);
+    other.storage.clear();
+    return *this;
+}
+
+// Reads a snapshot written by save, in the byte order of the machine that wrote it
+frozen_triangulation frozen_triangulation::load(std::istream &is)
+{
+    header h;
+    if (!is.read(reinterpret_cast<char*>(&h), sizeof(header)) or !isValidHeader(h))
+        throw invalidSnapshotException();
+
+    frozen_triangulation frozen;
+    size_t size = bufferSize(h.numVertices, h.numTriangles);
+    frozen.storage.resize(sizeof(header));
+    std::memcpy(frozen.storage.data(), &h, sizeof(header));
+    while (frozen.storage.size() < size)
+    {
+        size_t offset = frozen.storage.size(), count = std::min(size - offset, LOAD_CHUNK_SIZE);
+        frozen.storage.resize(offset + count);
+        if (!is.read(frozen.storage.data() + offset, count))
+            throw invalidSnapshotException();
+    }
+    frozen.view(frozen.storage.data());
+    if (!frozen.hasValidIndices())
+        throw invalidSnapshotException();
+    return frozen;
+}
+
+void frozen_triangulation::save(std::ostream &os) const
+{
+    if (head == NULL) return;
+    os.write(reinterpret_cast<const char*>(head), bufferSize(head -> numVertices, head -> numTriangles));
+}
+
+/* Accessors */
+
+int frozen_triangulation::getNumVertices() const
+{
+    return head == NULL ? 0 : head -> numVertices;
+}
+
+int frozen_triangulation::getNumTriangles() const
+{
+    return head == NULL ? 0 : head -> numTriangles;
+}
+
+point frozen_triangulation::vertexPosition(int v) const
+{
+    return point(xs[v], ys[v]);
+}
+
+int frozen_triangulation::vertexIndex(int t, int i) const
+{
+    return vertices[3 * t + i];
+}
+
+int frozen_triangulation::neighbor(int t, int i) const
+{
+    return neighbors[3 * t + i];
+}
+
+int frozen_triangulation::faceLabel(int t) const
+{
+    return labels[t];
+}
+
+/* Point Location */
+
+// Triangles are in Hilbert order, so evenly spaced triangles are spread over the whole plane
+int frozen_triangulation::startTriangle(point p) const
+{
+    int numTriangles = getNumTriangles();
+    if (numTriangles == 0) return -1;
+    int numSamples = std::max(1, (int) std::cbrt(numTriangles));
+    int best = 0;
+    T best_distance = std::numeric_limits<T>::infinity();
+    for (int s = 0; s < numSamples; s++)
+    {
+        int t = (long long) s * numTriangles / numSamples;
+        T dx = xs[vertices[3 * t]] - p.x, dy = ys[vertices[3 * t]] - p.y;
+        if (dx * dx + dy * dy < best_distance)
+        {
+            best_distance = dx * dx + dy * dy;
+            best = t;
+        }
+    }
+    return best;
+}
+
+int frozen_triangulation::locate(point p) const
+{
+    return locate(p, startTriangle(p));
+}
+
+int frozen_triangulation::locate(point p, int start) const
+{
+    if (start < 0) return -1;
+    xorshift_rng rng;
+    int t = start, previous = -1;
+    while (true)
+    {
+        int first = rng.next() % 3, next = t;
+        for (int k = 0; k < 3; k++)
+        {
+            int i = first + k < 3 ? first + k : first + k - 3;
+            int across = neighbors[3 * t + i];
+            // The edge shared with the previous triangle was already crossed towards p
+            if (across == previous and previous != -1) continue;
+            int a = vertices[3 * t + i], b = vertices[3 * t + (i + 1 < 3 ? i + 1 : 0)];
+            // If p is to the right of the edge, go to the triangle across it
+            if (orientation(point(xs[a], ys[a]), point(xs[b], ys[b]), p) > 0)
+            {
+                if (across == -1) return -1;
+                next = across;
+                break;
+            }
+        }
+        // If no right turns are made from the edges to point p, then p must be inside the triangle
+        if (next == t) return t;
+        previous = t;
+        t = next;
+    }
+}
+
+void frozen_triangulation::locate_batch(const point* points, size_t numPoints, int* located) const
+{
+    int previous = -1;
+    for (size_t i: hilbertOrder(points, numPoints))
+    {
+        located[i] = locate(points[i], previous == -1 ? startTriangle(points[i]) : previous);
+        if (located[i] != -1) previous = located[i];
+    }
+}
+
+// Returns the number of bytes of the buffer, which is the whole snapshot
+size_t frozen_triangulation::getMemoryUsage() const
+{
+    return bufferSize(getNumVertices(), getNumTriangles());
+}
@@ -0,0 +1,62 @@
+#include "geo_primitives/hilbert_curve.h"
+#include <algorithm>
+#include <utility>
+
+unsigned long long hilbertIndex(unsigned int x, unsigned int y)
+{
+    unsigned long long index = 0;
+    for (unsigned int s = 1u << 31; s > 0; s >>= 1)
+    {
+        unsigned int rx = (x & s) != 0, ry = (y & s) != 0;
+        index += (unsigned long long) s * s * ((3 * rx) ^ ry);
+        // Rotate the quadrant so that the curve inside it starts and ends where the curve of the whole grid does
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = ~x;
+                y = ~y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return index;
+}
+
+unsigned long long hilbertIndex(const point2D &p, const std::tuple <T, T, T, T> &bounding_box)
+{
+    T left, top, right, bottom;
+    std::tie(left, top, right, bottom) = bounding_box;
+    const T maxCell = 4294967295.0;
+    auto toCell = [&](T value, T low, T high) -> unsigned int
+    {
+        if (!(high > low) or !(value > low)) return 0;
+        if (value >= high) return maxCell;
+        return (value - low) / (high - low) * maxCell;
+    };
+    return hilbertIndex(toCell(p.x, left, right), toCell(p.y, bottom, top));
+}
+
+std::vector <size_t> hilbertOrder(const point2D* points, size_t numPoints)
+{
+    std::vector <size_t> order(numPoints);
+    if (numPoints == 0) return order;
+
+    T left = points[0].x, top = points[0].y, right = points[0].x, bottom = points[0].y;
+    for (size_t i = 1; i < numPoints; i++)
+    {
+        left = std::min(left, points[i].x);
+        right = std::max(right, points[i].x);
+        bottom = std::min(bottom, points[i].y);
+        top = std::max(top, points[i].y);
+    }
+    std::tuple <T, T, T, T> bounding_box{left, top, right, bottom};
+
+    std::vector <std::pair <unsigned long long, size_t>> keys(numPoints);
+    for (size_t i = 0; i < numPoints; i++)
+        keys[i] = {hilbertIndex(points[i], bounding_box), i};
+    std::sort(keys.begin(), keys.end());
+    for (size_t i = 0; i < numPoints; i++)
+        order[i] = keys[i].second;
+    return order;
+}
@@ -0,0 +1,189 @@
+#include "point_location/non_walking/hilbert_rtree.h"
+#include "planar_structure/plane.h"
+#include "data_structures/quadtree.h"
+#include "geo_primitives/hilbert_curve.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <assert.h>
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    using box = std::tuple <T, T, T, T>;
+
+    // Deepest tree that a query supports, FANOUT^16 faces is far more than fit in memory
+    const int MAX_LEVELS = 16;
+
+    box emptyBox()
+    {
+        const T inf = std::numeric_limits<T>::infinity();
+        return std::make_tuple(inf, -inf, -inf, inf);
+    }
+
+    box unite(const box &a, const box &b)
+    {
+        return std::make_tuple(std::min(std::get<0>(a), std::get<0>(b)), std::max(std::get<1>(a), std::get<1>(b)),
+                               std::max(std::get<2>(a), std::get<2>(b)), std::min(std::get<3>(a), std::get<3>(b)));
+    }
+}
+
+hilbert_rtree::node::node()
+{
+    const T nan = std::numeric_limits<T>::quiet_NaN();
+    for (int i = 0; i < FANOUT; i++)
+        left[i] = top[i] = right[i] = bottom[i] = nan;
+}
+
+void hilbert_rtree::node::set(int lane, const std::tuple <T, T, T, T> &child_box)
+{
+    assert(lane >= 0 and lane < FANOUT);
+    std::tie(left[lane], top[lane], right[lane], bottom[lane]) = child_box;
+}
+
+// Returns a mask with bit i set iff the closed box of child i contains p
+int hilbert_rtree::node::contains(const point &p) const
+{
+    int mask = 0;
+#if defined(__AVX2__)
+    __m256d px = _mm256_set1_pd(p.x), py = _mm256_set1_pd(p.y);
+    for (int first = 0; first < FANOUT; first += 4)
+    {
+        __m256d in_x = _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(left + first), px, _CMP_LE_OQ), _mm256_cmp_pd(px, _mm256_loadu_pd(right + first), _CMP_LE_OQ));
+        __m256d in_y = _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(bottom + first), py, _CMP_LE_OQ), _mm256_cmp_pd(py, _mm256_loadu_pd(top + first), _CMP_LE_OQ));
+        mask |= _mm256_movemask_pd(_mm256_and_pd(in_x, in_y)) << first;
+    }
+#elif defined(__SSE2__)
+    __m128d px = _mm_set1_pd(p.x), py = _mm_set1_pd(p.y);
+    for (int first = 0; first < FANOUT; first += 2)
+    {
+        __m128d in_x = _mm_and_pd(_mm_cmple_pd(_mm_loadu_pd(left + first), px), _mm_cmple_pd(px, _mm_loadu_pd(right + first)));
+        __m128d in_y = _mm_and_pd(_mm_cmple_pd(_mm_loadu_pd(bottom + first), py), _mm_cmple_pd(py, _mm_loadu_pd(top + first)));
+        mask |= _mm_movemask_pd(_mm_and_pd(in_x, in_y)) << first;
+    }
+#else
+    // Comparisons are written so that NaN padding never contains p
+    for (int i = 0; i < FANOUT; i++)
+        mask |= (left[i] <= p.x and p.x <= right[i] and bottom[i] <= p.y and p.y <= top[i]) << i;
+#endif
+    return mask;
+}
+
+/* Construction */
+
+// Sorting the faces along the Hilbert curve takes O(n log n) time, packing the leaves and the levels above them takes O(n)
+void hilbert_rtree::init(plane &pln)
+{
+    std::vector <edge*> dual_faces;
+    for (edge* face: pln.traverse(dualGraph, traverseNodes))
+    {
+        if (face -> origin().getLabel() == 0) continue;
+        dual_faces.push_back(face);
+    }
+
+    std::vector <box> face_boxes(dual_faces.size());
+    std::vector <std::pair <unsigned long long, int>> order(dual_faces.size());
+    for (int i = 0; i < dual_faces.size(); i++)
+    {
+        face_boxes[i] = faceBoundingBox(dual_faces[i]);
+        point center((std::get<0>(face_boxes[i]) + std::get<2>(face_boxes[i])) / 2, (std::get<1>(face_boxes[i]) + std::get<3>(face_boxes[i])) / 2);
+        order[i] = {hilbertIndex(center, pln.bounds), i};
+    }
+    std::sort(order.begin(), order.end());
+
+    // Leaves, along with the boxes of the level being packed
+    int numLeaves = (dual_faces.size() + FANOUT - 1) / FANOUT;
+    faces.resize(dual_faces.size());
+    blocks.assign(numLeaves * BLOCKS_PER_LEAF, triangle_block());
+    std::vector <box> level_boxes(numLeaves, emptyBox());
+    for (int i = 0; i < order.size(); i++)
+    {
+        faces[i] = dual_faces[order[i].second] -> rot();
+        blocks[i / triangle_block::WIDTH].set(i % triangle_block::WIDTH, faces[i]);
+        level_boxes[i / FANOUT] = unite(level_boxes[i / FANOUT], face_boxes[order[i].second]);
+    }
+
+    // Levels are packed bottom up, then stored root first
+    std::vector <std::vector <node>> levels;
+    do
+    {
+        int numNodes = (level_boxes.size() + FANOUT - 1) / FANOUT;
+        std::vector <node> level(numNodes);
+        std::vector <box> parent_boxes(numNodes, emptyBox());
+        for (int i = 0; i < level_boxes.size(); i++)
+        {
+            level[i / FANOUT].set(i % FANOUT, level_boxes[i]);
+            parent_boxes[i / FANOUT] = unite(parent_boxes[i / FANOUT], level_boxes[i]);
+        }
+        levels.push_back(std::move(level));
+        level_boxes.swap(parent_boxes);
+    } while (level_boxes.size() > 1);
+    assert(levels.size() <= MAX_LEVELS);
+
+    nodes.clear();
+    level_offsets.assign(1, 0);
+    for (auto level = levels.rbegin(); level != levels.rend(); ++level)
+    {
+        nodes.insert(nodes.end(), level -> begin(), level -> end());
+        level_offsets.push_back(nodes.size());
+    }
+
+    auto dimension = getDimensions();
+    std::cout << "Hilbert R-tree Dimensions -> Num Nodes: " << dimension.first << " Depth: " << dimension.second << " Memory: " << getMemoryUsage() << " bytes" << std::endl;
+}
+
+/* Point Location */
+
+// Returns pointer to some edge that belongs to the face that contains p
+// Returns NULL if p is outside the plane
+edge* hilbert_rtree::locate(point p)
+{
+    if (nodes.empty())
+        return NULL;
+
+    // Nodes left to visit as (level, index in level), children are pushed in reverse so that they are visited in Hilbert order
+    // Every level adds at most FANOUT - 1 nodes to the stack on top of the one it removes
+    std::pair <int, int> stack[MAX_LEVELS * FANOUT];
+    int numPending = 0;
+    int numLevels = level_offsets.size() - 1;
+    stack[numPending++] = {0, 0};
+    while (numPending > 0)
+    {
+        int level, index;
+        std::tie(level, index) = stack[--numPending];
+        int mask = nodes[level_offsets[level] + index].contains(p);
+        if (level + 1 == numLevels)
+        {
+            // Children of the last level are leaves, which are scanned right away
+            for (; mask != 0; mask &= mask - 1)
+            {
+                int leaf = index * FANOUT + __builtin_ctz(mask);
+                int found = findInBlocks(blocks.data() + leaf * BLOCKS_PER_LEAF, BLOCKS_PER_LEAF, p);
+                if (found != -1)
+                    return faces[leaf * FANOUT + found];
+            }
+            continue;
+        }
+        while (mask != 0)
+        {
+            int child = 31 - __builtin_clz(mask);
+            mask ^= 1 << child;
+            stack[numPending++] = {level + 1, index * FANOUT + child};
+        }
+    }
+    return NULL;
+}
+
+// Returns number of nodes along with the number of levels of nodes
+std::pair <int, int> hilbert_rtree::getDimensions()
+{
+    return {nodes.size(), level_offsets.size() - 1};
+}
+
+// Returns the number of bytes used by the nodes, the leaf triangles and the face table
+size_t hilbert_rtree::getMemoryUsage()
+{
+    return nodes.size() * sizeof(node) + level_offsets.size() * sizeof(int) + blocks.size() * sizeof(triangle_block) + faces.size() * sizeof(edge*);
+}
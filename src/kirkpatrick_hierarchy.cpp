@@ -0,0 +1,264 @@
+#include "point_location/non_walking/kirkpatrick_hierarchy.h"
+#include "planar_structure/plane.h"
+#include <unordered_map>
+#include <algorithm>
+#include <assert.h>
+
+kirkpatrick_hierarchy::kirkpatrick_hierarchy(int degreeBound)
+{
+    MAX_DEGREE = degreeBound;
+}
+
+/* Geometry Helpers */
+
+// Returns true if p is inside or on the boundary of triangle t
+bool kirkpatrick_hierarchy::contains(const triangle &t, const point &p) const
+{
+    for (int i = 0; i < 3; i++)
+    {
+        int inext = i + 1 < 3 ? i + 1 : 0;
+        // Triangles are oriented ccw, so p cannot be inside t if it is strictly to the right of an edge
+        if (orientation(vertices[t.v[i]], vertices[t.v[inext]], p) > 0)
+            return false;
+    }
+    return true;
+}
+
+// Returns true if the interiors of triangles a and b intersect
+// Two convex polygons have disjoint interiors iff one of their edges separates them (touching boundaries do not count as overlaps)
+bool kirkpatrick_hierarchy::overlaps(const triangle &a, const triangle &b) const
+{
+    const triangle* tri[2] = {&a, &b};
+    for (int k = 0; k < 2; k++)
+    {
+        const triangle &t = *tri[k], &o = *tri[k ^ 1];
+        for (int i = 0; i < 3; i++)
+        {
+            int inext = i + 1 < 3 ? i + 1 : 0;
+            bool separating = true;
+            for (int j = 0; j < 3; j++)
+            {
+                if (orientation(vertices[t.v[i]], vertices[t.v[inext]], vertices[o.v[j]]) < 0)
+                {
+                    separating = false;
+                    break;
+                }
+            }
+            if (separating)
+                return false;
+        }
+    }
+    return true;
+}
+
+// Assumes that polygon is simple and its vertices are given in ccw order
+// Triangulates the polygon by ear clipping, returning each triangle as 3 vertex indices in ccw order
+// Polygons are the holes left after removing a low degree vertex, so they are small and quadratic time is fine
+std::vector <std::vector <int>> kirkpatrick_hierarchy::triangulatePolygon(std::vector <int> polygon) const
+{
+    std::vector <std::vector <int>> result;
+    while (polygon.size() > 3)
+    {
+        int sz = polygon.size();
+        int ear = -1;
+        for (int i = 0; i < sz and ear == -1; i++)
+        {
+            const point &a = vertices[polygon[(i + sz - 1) % sz]];
+            const point &b = vertices[polygon[i]];
+            const point &c = vertices[polygon[(i + 1) % sz]];
+            // Ear tip must form a strict left turn
+            if (orientation(a, b, c) >= 0) continue;
+            // No other vertex of the polygon can be inside or on the boundary of the ear
+            bool empty = true;
+            for (int j = 0; j < sz and empty; j++)
+            {
+                const point &q = vertices[polygon[j]];
+                if (q == a or q == b or q == c) continue;
+                if (orientation(a, b, q) <= 0 and orientation(b, c, q) <= 0 and orientation(c, a, q) <= 0)
+                    empty = false;
+            }
+            if (empty)
+                ear = i;
+        }
+        // Every simple polygon has an ear
+        assert(ear != -1);
+        result.push_back({polygon[(ear + sz - 1) % sz], polygon[ear], polygon[(ear + 1) % sz]});
+        polygon.erase(polygon.begin() + ear);
+    }
+    result.push_back(polygon);
+    return result;
+}
+
+/* Hierarchy Construction */
+
+// Removes vertex v from the current level and retriangulates the hole left behind
+// Each new triangle is linked to the triangles of the previous level that it overlaps
+void kirkpatrick_hierarchy::removeVertex(int v, std::vector <std::vector <int>> &incident, std::vector <bool> &replaced)
+{
+    std::vector <int> old_triangles = incident[v];
+
+    // Every incident triangle (v, a, b) contributes the edge a -> b to the polygon surrounding v
+    std::vector <std::pair <int, int>> link;
+    for (int t: old_triangles)
+    {
+        const triangle &tri = triangles[t];
+        int pos = std::find(tri.v, tri.v + 3, v) - tri.v;
+        link.push_back({tri.v[(pos + 1) % 3], tri.v[(pos + 2) % 3]});
+    }
+    std::vector <int> polygon = {link[0].first};
+    while (polygon.size() < link.size())
+    {
+        for (auto &link_edge: link)
+        {
+            if (link_edge.first == polygon.back())
+            {
+                polygon.push_back(link_edge.second);
+                break;
+            }
+        }
+    }
+
+    for (int u: polygon)
+    {
+        auto &list = incident[u];
+        list.erase(std::remove_if(list.begin(), list.end(), [&](int t){return std::find(old_triangles.begin(), old_triangles.end(), t) != old_triangles.end();}), list.end());
+    }
+    for (int t: old_triangles)
+        replaced[t] = true;
+    incident[v].clear();
+
+    for (auto &vertex_indices: triangulatePolygon(polygon))
+    {
+        triangle new_triangle = {{vertex_indices[0], vertex_indices[1], vertex_indices[2]}, (int) children.size(), 0, NULL};
+        for (int t: old_triangles)
+        {
+            if (overlaps(new_triangle, triangles[t]))
+                children.push_back(t);
+        }
+        new_triangle.childEnd = children.size();
+
+        int index = triangles.size();
+        triangles.push_back(new_triangle);
+        replaced.push_back(false);
+        for (int u: vertex_indices)
+            incident[u].push_back(index);
+    }
+}
+
+// Assumes that every bounded face of the plane is a triangle
+// Builds the hierarchy by repeatedly removing an independent set of low degree vertices that are not on the outer boundary
+void kirkpatrick_hierarchy::init(plane &pln)
+{
+    vertices.clear();
+    triangles.clear();
+    children.clear();
+    roots.clear();
+
+    std::unordered_map <vertex*, int> vertex_index;
+    for (edge* e: pln.traverse(primalGraph, traverseNodes))
+    {
+        vertex_index[&e -> origin()] = vertices.size();
+        vertices.push_back(e -> originPosition());
+    }
+
+    std::vector <std::vector <int>> incident(vertices.size());
+    std::vector <bool> onBoundary(vertices.size(), false);
+    for (edge* face: pln.traverse(dualGraph, traverseNodes))
+    {
+        if (face -> origin().getLabel() == 0) continue;
+        triangle t = {{0, 0, 0}, 0, 0, face -> rot()};
+        int sz = 0;
+        for (auto it = face -> rot() -> begin(incidentOnFace); it != face -> rot() -> end(incidentOnFace); ++it)
+        {
+            // Make sure that the face is a triangle
+            assert(sz < 3);
+            t.v[sz++] = vertex_index[&it -> origin()];
+            // Vertices on the outer boundary can never be removed
+            if (it -> rightfaceLabel() == 0)
+            {
+                onBoundary[vertex_index[&it -> origin()]] = true;
+                onBoundary[vertex_index[&it -> destination()]] = true;
+            }
+        }
+        assert(sz == 3);
+        for (int u: t.v)
+            incident[u].push_back(triangles.size());
+        triangles.push_back(t);
+    }
+
+    std::vector <bool> replaced(triangles.size(), false);
+    std::vector <bool> removed(vertices.size(), false);
+    std::vector <int> blocked(vertices.size(), -1);
+    numLevels = 1;
+    while (true)
+    {
+        // Greedily pick an independent set of removable vertices, blocking the neighbors of each chosen vertex
+        std::vector <int> independent_set;
+        for (int v = 0; v < vertices.size(); v++)
+        {
+            if (removed[v] or onBoundary[v] or blocked[v] == numLevels or incident[v].size() > MAX_DEGREE) continue;
+            independent_set.push_back(v);
+            for (int t: incident[v])
+                for (int u: triangles[t].v)
+                    blocked[u] = numLevels;
+        }
+        if (independent_set.empty()) break;
+
+        for (int v: independent_set)
+        {
+            removeVertex(v, incident, replaced);
+            removed[v] = true;
+        }
+        numLevels++;
+    }
+
+    for (int t = 0; t < triangles.size(); t++)
+    {
+        if (!replaced[t])
+            roots.push_back(t);
+    }
+
+    auto dimension = getDimensions();
+    std::cout << "Kirkpatrick Hierarchy Dimensions -> Num Triangles: " << dimension.first << " Num Levels: " << dimension.second << std::endl;
+}
+
+/* Point Location */
+
+// Returns pointer to some edge that belongs to the face that contains p
+// Returns NULL if p is outside the plane
+edge* kirkpatrick_hierarchy::locate(point p)
+{
+    int curr = -1;
+    for (int t: roots)
+    {
+        if (contains(triangles[t], p))
+        {
+            curr = t;
+            break;
+        }
+    }
+    if (curr == -1) return NULL;
+
+    // Children of a triangle cover it, so one of them must contain p
+    while (triangles[curr].face == NULL)
+    {
+        int next = -1;
+        for (int i = triangles[curr].childBegin; i < triangles[curr].childEnd; i++)
+        {
+            if (contains(triangles[children[i]], p))
+            {
+                next = children[i];
+                break;
+            }
+        }
+        if (next == -1) return NULL;
+        curr = next;
+    }
+    return triangles[curr].face;
+}
+
+// Returns number of triangles across all levels of the hierarchy along with the number of levels
+std::pair <int, int> kirkpatrick_hierarchy::getDimensions()
+{
+    return {triangles.size(), numLevels};
+}
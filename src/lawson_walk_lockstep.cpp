@@ -0,0 +1,187 @@
+#include "point_location/walking/lawson_walk.h"
+#include <limits>
+#include <assert.h>
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    const int LANES = 32;
+    const int VECTOR_WIDTH = 4;
+
+    // Coordinates of the current triangle of every lane and of its query point, as structure of arrays
+    // Edges of the triangle are ab (the current edge), bc and ca
+    struct lane_coordinates
+    {
+        alignas(32) T ax[LANES], ay[LANES], bx[LANES], by[LANES], cx[LANES], cy[LANES], px[LANES], py[LANES];
+    };
+
+    bool isTriangle(edge* e)
+    {
+        return e -> fnext() -> fnext() -> fnext() == e;
+    }
+
+    // Sets bit i of right[k] iff query point i is strictly to the right of edge k of its triangle, for the lanes [first, first + VECTOR_WIDTH)
+    // Every orientation is computed exactly like orientation(a, b, p) = cross(p - a, b - a), so lanes agree with the scalar walks
+    void rightTurns(const lane_coordinates &l, int first, int right[3])
+    {
+#if defined(__AVX2__)
+        __m256d px = _mm256_load_pd(l.px + first), py = _mm256_load_pd(l.py + first), zero = _mm256_setzero_pd();
+        auto right_of = [&](__m256d ax, __m256d ay, __m256d bx, __m256d by)
+        {
+            __m256d o = _mm256_sub_pd(_mm256_mul_pd(_mm256_sub_pd(px, ax), _mm256_sub_pd(by, ay)), _mm256_mul_pd(_mm256_sub_pd(py, ay), _mm256_sub_pd(bx, ax)));
+            return _mm256_movemask_pd(_mm256_cmp_pd(o, zero, _CMP_GT_OQ));
+        };
+        __m256d ax = _mm256_load_pd(l.ax + first), ay = _mm256_load_pd(l.ay + first);
+        __m256d bx = _mm256_load_pd(l.bx + first), by = _mm256_load_pd(l.by + first);
+        __m256d cx = _mm256_load_pd(l.cx + first), cy = _mm256_load_pd(l.cy + first);
+        right[0] = right_of(ax, ay, bx, by);
+        right[1] = right_of(bx, by, cx, cy);
+        right[2] = right_of(cx, cy, ax, ay);
+#elif defined(__SSE2__)
+        right[0] = right[1] = right[2] = 0;
+        for (int half = 0; half < VECTOR_WIDTH; half += 2)
+        {
+            int i = first + half;
+            __m128d px = _mm_load_pd(l.px + i), py = _mm_load_pd(l.py + i), zero = _mm_setzero_pd();
+            auto right_of = [&](__m128d ax, __m128d ay, __m128d bx, __m128d by)
+            {
+                __m128d o = _mm_sub_pd(_mm_mul_pd(_mm_sub_pd(px, ax), _mm_sub_pd(by, ay)), _mm_mul_pd(_mm_sub_pd(py, ay), _mm_sub_pd(bx, ax)));
+                return _mm_movemask_pd(_mm_cmpgt_pd(o, zero));
+            };
+            __m128d ax = _mm_load_pd(l.ax + i), ay = _mm_load_pd(l.ay + i);
+            __m128d bx = _mm_load_pd(l.bx + i), by = _mm_load_pd(l.by + i);
+            __m128d cx = _mm_load_pd(l.cx + i), cy = _mm_load_pd(l.cy + i);
+            right[0] |= right_of(ax, ay, bx, by) << half;
+            right[1] |= right_of(bx, by, cx, cy) << half;
+            right[2] |= right_of(cx, cy, ax, ay) << half;
+        }
+#else
+        right[0] = right[1] = right[2] = 0;
+        for (int lane = 0; lane < VECTOR_WIDTH; lane++)
+        {
+            int i = first + lane;
+            point a(l.ax[i], l.ay[i]), b(l.bx[i], l.by[i]), c(l.cx[i], l.cy[i]), p(l.px[i], l.py[i]);
+            // Comparisons are written so that NaN lanes never make a right turn
+            right[0] |= (orientation(a, b, p) > 0) << lane;
+            right[1] |= (orientation(b, c, p) > 0) << lane;
+            right[2] |= (orientation(c, a, p) > 0) << lane;
+        }
+#endif
+    }
+}
+
+/*
+* Walks to points[i] from startEdges[i] for every i < numPoints with a fast remembering walk (see lawson_oriented_walk), LANES walks at a time
+* Every round gathers the triangle of each walk into lanes, evaluates the orientation tests of all lanes with SIMD instructions (4 lanes per instruction with AVX2, 2 with SSE2)
+*      and then advances every walk by one face according to its own tests
+* Finished walks hand their lane to the next point, and once no point is left the remaining walks are compacted into the first lanes so empty vectors are skipped
+* Assumes that every bounded face is a triangle, the walks take the same steps as lawson_walk_locate<false, true, true> and count tests and faces the same way
+*/
+void lawson_walk_lockstep(edge* const* startEdges, const point* points, size_t numPoints, edge** located,
+                          unsigned int maxFastSteps, int &numTests, int &numFaces)
+{
+    xorshift_rng rng;
+    lane_coordinates l;
+    const T nan = std::numeric_limits<T>::quiet_NaN();
+    for (int i = 0; i < LANES; i++)
+        l.ax[i] = l.ay[i] = l.bx[i] = l.by[i] = l.cx[i] = l.cy[i] = l.px[i] = l.py[i] = nan;
+
+    lawson_walk_state walks[LANES];
+    edge* faceEdges[LANES][3];
+    size_t query[LANES];
+    int numWalks = 0;
+    size_t nextQuery = 0;
+    while (true)
+    {
+        for (; numWalks < LANES and nextQuery < numPoints; nextQuery++)
+        {
+            // Walks starting on a face that is not a triangle (like the outside face) take scalar steps until they reach a triangle, which they never leave
+            lawson_walk_state walk{startEdges[nextQuery], maxFastSteps, true, 0};
+            bool done = false;
+            while (!done and !isTriangle(walk.currEdge))
+                done = lawson_walk_step<false, true, true>(walk, points[nextQuery], rng, numTests, numFaces);
+            if (done)
+            {
+                located[nextQuery] = walk.currEdge;
+                continue;
+            }
+            walks[numWalks] = walk;
+            query[numWalks] = nextQuery;
+            l.px[numWalks] = points[nextQuery].x, l.py[numWalks] = points[nextQuery].y;
+            numWalks++;
+        }
+        if (numWalks == 0) break;
+
+        // Gather the triangles, lanes past numWalks keep NaN coordinates
+        for (int i = 0; i < numWalks; i++)
+        {
+            edge* e0 = walks[i].currEdge;
+            edge* e1 = e0 -> fnext();
+            edge* e2 = e1 -> fnext();
+            faceEdges[i][0] = e0, faceEdges[i][1] = e1, faceEdges[i][2] = e2;
+            point a = e0 -> originPosition(), b = e1 -> originPosition(), c = e2 -> originPosition();
+            l.ax[i] = a.x, l.ay[i] = a.y, l.bx[i] = b.x, l.by[i] = b.y, l.cx[i] = c.x, l.cy[i] = c.y;
+        }
+        int right[LANES / VECTOR_WIDTH][3];
+        for (int v = 0; v * VECTOR_WIDTH < numWalks; v++)
+            rightTurns(l, v * VECTOR_WIDTH, right[v]);
+
+        for (int i = numWalks - 1; i >= 0; i--)
+        {
+            lawson_walk_state &walk = walks[i];
+            int bit = 1 << (i % VECTOR_WIDTH);
+            bool rightOf[3] = {(right[i / VECTOR_WIDTH][0] & bit) != 0, (right[i / VECTOR_WIDTH][1] & bit) != 0, (right[i / VECTOR_WIDTH][2] & bit) != 0};
+            bool done = false;
+
+            if (walk.fastStepsLeft > 0)
+            {
+                // Same step as the fast portion of lawson_walk_step, only the test of the second edge is used
+                walk.fastStepsLeft--;
+                numTests++;
+                numFaces++;
+                edge* candidate = rightOf[1] ? faceEdges[i][1] -> twin() : faceEdges[i][2] -> twin();
+                if (candidate -> rightfaceLabel() == 0)
+                    walk.fastStepsLeft = 0;
+                else
+                    walk.currEdge = candidate;
+            }
+            else
+            {
+                // Same step as the regular portion of lawson_walk_step, the current edge is only tested on the first face
+                int k = walk.firstIteration ? 0 : 1;
+                while (k < 3 and !rightOf[k])
+                    k++;
+                numTests += std::min(k + 1, 3) - (walk.firstIteration ? 0 : 1);
+                numFaces++;
+                if (k == 3)
+                    done = true;
+                else if (faceEdges[i][k] -> rightfaceLabel() == 0)
+                {
+                    walk.currEdge = NULL;
+                    done = true;
+                }
+                else
+                {
+                    walk.currEdge = faceEdges[i][k] -> twin();
+                    walk.firstIteration = false;
+                }
+            }
+
+            if (done)
+            {
+                located[query[i]] = walk.currEdge;
+                // Compaction, the last walk moves into the finished lane
+                numWalks--;
+                walks[i] = walks[numWalks];
+                query[i] = query[numWalks];
+                l.px[i] = l.px[numWalks], l.py[i] = l.py[numWalks];
+                l.ax[numWalks] = l.ay[numWalks] = l.bx[numWalks] = l.by[numWalks] = l.cx[numWalks] = l.cy[numWalks] = nan;
+                l.px[numWalks] = l.py[numWalks] = nan;
+            }
+            else
+                __builtin_prefetch(walk.currEdge);
+        }
+    }
+}
@@ -0,0 +1,430 @@
+#include "data_structures/linear_quadtree.h"
+#include "data_structures/quadtree.h"
+#include "data_structures/batch_search.h"
+#include "quadedge_structure/quadedge.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <assert.h>
+
+// std::min binds its arguments to references, so the constant needs a definition
+const int linear_quadtree::MAX_CODE_DEPTH;
+
+void linear_quadtree::setParameters(int overlapBound, int depthBound)
+{
+    MAX_OVERLAP = overlapBound;
+    MAX_DEPTH = depthBound;
+}
+
+/* Helper Functions */
+
+// Returns the Morton code of cell (x, y), bits of y are placed above the bits of x at every level
+unsigned long long linear_quadtree::interleave(unsigned int x, unsigned int y)
+{
+    auto spread = [](unsigned long long v)
+    {
+        v = (v | (v << 16)) & 0x0000FFFF0000FFFFULL;
+        v = (v | (v << 8)) & 0x00FF00FF00FF00FFULL;
+        v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        v = (v | (v << 2)) & 0x3333333333333333ULL;
+        v = (v | (v << 1)) & 0x5555555555555555ULL;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+// Returns (left, top, right, bottom) of cell (cx, cy) of the given level, where cell (0, 0) is the lower left one
+// Every boundary is computed from the index of the cell to its right or top, so neighboring cells (of any level) share it exactly
+std::tuple <T, T, T, T> linear_quadtree::cellBounds(unsigned int cx, unsigned int cy, int level) const
+{
+    T cell_width = std::ldexp(width, -level), cell_height = std::ldexp(height, -level);
+    unsigned long long numCells = 1ULL << level;
+    T cell_left = left + cx * cell_width, cell_bottom = bottom + cy * cell_height;
+    T cell_right = cx + 1 == numCells ? right : left + (cx + 1) * cell_width;
+    T cell_top = cy + 1 == numCells ? top : bottom + (cy + 1) * cell_height;
+    return std::make_tuple(cell_left, cell_top, cell_right, cell_bottom);
+}
+
+// A cell can only be split while its midpoint is strictly inside it, so cells keep halving until double precision runs out
+bool linear_quadtree::canSplit(unsigned int cx, unsigned int cy, int level) const
+{
+    T cell_left, cell_top, cell_right, cell_bottom;
+    std::tie(cell_left, cell_top, cell_right, cell_bottom) = cellBounds(cx, cy, level);
+    T midx = std::get<0>(cellBounds(2 * cx + 1, 2 * cy + 1, level + 1));
+    T midy = std::get<3>(cellBounds(2 * cx + 1, 2 * cy + 1, level + 1));
+    return cell_left < midx and midx < cell_right and cell_bottom < midy and midy < cell_top;
+}
+
+/* Construction */
+
+// Builds the subtree of cell (cx, cy) of the given level top down, appending its leaves to out in Morton order
+// A cell is split under the same conditions as a pointer quadtree node that had its faces inserted one by one
+// Subtrees of the top levels are built by separate threads into their own buffers
+void linear_quadtree::build(const std::vector <int> &cell_faces, unsigned int cx, unsigned int cy, int level, const std::function <std::tuple <T, T, T, T>(int)> &box_of, int numThreads, leaf_buffer &out) const
+{
+    if (cell_faces.size() < MAX_OVERLAP or level >= std::min(MAX_DEPTH, codeDepth) or !canSplit(cx, cy, level))
+    {
+        out.codes.push_back(interleave(cx, cy) << (2 * (codeDepth - level)));
+        out.sizes.push_back(cell_faces.size());
+        out.ids.insert(out.ids.end(), cell_faces.begin(), cell_faces.end());
+        out.depth = std::max(out.depth, level);
+        return;
+    }
+
+    auto build_child = [&](int quadrant, leaf_buffer &child_out)
+    {
+        unsigned int child_x = 2 * cx + (quadrant & 1), child_y = 2 * cy + (quadrant >> 1);
+        std::tuple <T, T, T, T> child_bounds = cellBounds(child_x, child_y, level + 1);
+        std::vector <int> child_faces;
+        for (int id: cell_faces)
+        {
+            if (boxOverlapsFace(child_bounds, faces[id] -> invrot(), box_of(id)))
+                child_faces.push_back(id);
+        }
+        build(child_faces, child_x, child_y, level + 1, box_of, numThreads / 4, child_out);
+    };
+
+    // Children are visited in increasing Morton order so that leaves come out sorted
+    if (numThreads > 1)
+    {
+        leaf_buffer child_out[4];
+        std::vector <std::thread> workers;
+        for (int quadrant = 1; quadrant < 4; quadrant++)
+            workers.emplace_back(build_child, quadrant, std::ref(child_out[quadrant]));
+        build_child(0, child_out[0]);
+        for (std::thread &worker: workers)
+            worker.join();
+        for (int quadrant = 0; quadrant < 4; quadrant++)
+        {
+            out.codes.insert(out.codes.end(), child_out[quadrant].codes.begin(), child_out[quadrant].codes.end());
+            out.sizes.insert(out.sizes.end(), child_out[quadrant].sizes.begin(), child_out[quadrant].sizes.end());
+            out.ids.insert(out.ids.end(), child_out[quadrant].ids.begin(), child_out[quadrant].ids.end());
+            out.depth = std::max(out.depth, child_out[quadrant].depth);
+        }
+    }
+    else
+    {
+        for (int quadrant = 0; quadrant < 4; quadrant++)
+            build_child(quadrant, out);
+    }
+}
+
+// dual_faces are dual edges outwards from the faces that should be stored, face_boxes[i] is the bounding box of dual_faces[i]
+void linear_quadtree::init(const std::tuple <T, T, T, T>& bounding_box, const std::vector <edge*> &dual_faces, const std::vector <std::tuple <T, T, T, T>> &face_boxes, int numThreads)
+{
+    std::tie(left, top, right, bottom) = bounding_box;
+    // Make sure that dimensions are valid
+    assert(left <= right and bottom <= top);
+    width = right - left;
+    height = top - bottom;
+    codeDepth = std::min(MAX_DEPTH, MAX_CODE_DEPTH);
+
+    // Faces are kept as primal edges whose left face is the stored face, so locate does not have to rotate them
+    faces.clear();
+    free_ids.clear();
+    for (edge* face: dual_faces)
+        faces.push_back(face -> rot());
+
+    std::vector <int> root_faces;
+    for (int id = 0; id < faces.size(); id++)
+        root_faces.push_back(id);
+    // The root keeps every face, like the root of a pointer quadtree
+    leaf_buffer out;
+    build(root_faces, 0, 0, 0, [&](int id){return face_boxes[id];}, numThreads, out);
+
+    leaf_codes = std::move(out.codes);
+    leaves.clear();
+    face_ids.clear();
+    std::vector <triangle_block>().swap(blocks);
+    numUnusedSlots = 0;
+    int next_id = 0;
+    for (int sz: out.sizes)
+    {
+        leaves.push_back(appendSlots(out.ids.data() + next_id, sz, 0));
+        next_id += sz;
+    }
+    depth = out.depth;
+
+    leaf_codes.shrink_to_fit();
+    face_ids.shrink_to_fit();
+}
+
+/* Online Updates */
+
+// Appends to out every leaf whose cell overlaps box (boundaries included), looking only at the leaves inside cell (cx, cy) of the given level
+void linear_quadtree::findLeaves(const std::tuple <T, T, T, T> &box, unsigned int cx, unsigned int cy, int level, std::vector <leaf_cell> &out) const
+{
+    T cell_left, cell_top, cell_right, cell_bottom, box_left, box_top, box_right, box_bottom;
+    std::tie(cell_left, cell_top, cell_right, cell_bottom) = cellBounds(cx, cy, level);
+    std::tie(box_left, box_top, box_right, box_bottom) = box;
+    if (box_right < cell_left or box_left > cell_right or box_top < cell_bottom or box_bottom > cell_top)
+        return;
+
+    // Leaves are cells of the tree, so the leaf holding the first code of the cell either is the cell or lies inside it
+    unsigned long long code = interleave(cx, cy) << (2 * (codeDepth - level));
+    unsigned long long span = 1ULL << (2 * (codeDepth - level));
+    int leaf = std::upper_bound(leaf_codes.begin(), leaf_codes.end(), code) - leaf_codes.begin() - 1;
+    if (leaf + 1 == leaf_codes.size() or leaf_codes[leaf + 1] >= code + span)
+    {
+        out.push_back({leaf, cx, cy, level});
+        return;
+    }
+    for (int quadrant = 0; quadrant < 4; quadrant++)
+        findLeaves(box, 2 * cx + (quadrant & 1), 2 * cy + (quadrant >> 1), level + 1, out);
+}
+
+// Stores face id (-1 for none) in the slot, keeping the packed coordinates in sync
+void linear_quadtree::setSlot(size_t slot, int id)
+{
+    face_ids[slot] = id;
+    if (id == -1)
+        blocks[slot / triangle_block::WIDTH].clear(slot % triangle_block::WIDTH);
+    else
+        blocks[slot / triangle_block::WIDTH].set(slot % triangle_block::WIDTH, faces[id]);
+}
+
+// Appends slots for a leaf holding the given faces (ids of -1 are skipped), padded to whole blocks and with room for at least capacity slots
+linear_quadtree::leaf_slots linear_quadtree::appendSlots(const int* ids, int numIds, int capacity)
+{
+    leaf_slots slots{(int) face_ids.size(), 0, 0};
+    auto append = [&](int id)
+    {
+        if (face_ids.size() % triangle_block::WIDTH == 0)
+            blocks.push_back(triangle_block());
+        face_ids.push_back(-1);
+        if (id != -1)
+            setSlot(face_ids.size() - 1, id);
+    };
+    for (int i = 0; i < numIds; i++)
+    {
+        if (ids[i] != -1)
+            append(ids[i]);
+    }
+    while (face_ids.size() % triangle_block::WIDTH != 0)
+        append(-1);
+    slots.size = face_ids.size() - slots.begin;
+    while (face_ids.size() < slots.begin + capacity or face_ids.size() % triangle_block::WIDTH != 0)
+        append(-1);
+    slots.capacity = face_ids.size() - slots.begin;
+    return slots;
+}
+
+// Puts face id into a hole of the leaf, making room for it if there is none, and returns the number of faces the leaf has afterwards
+int linear_quadtree::addToLeaf(int leaf, int id)
+{
+    int numFaces = 0, hole = -1;
+    for (int slot = leaves[leaf].begin; slot < leaves[leaf].begin + leaves[leaf].size; slot++)
+    {
+        if (face_ids[slot] != -1)
+            numFaces++;
+        else if (hole == -1)
+            hole = slot;
+    }
+    if (hole == -1)
+    {
+        if (leaves[leaf].size == leaves[leaf].capacity)
+        {
+            // Appending may reallocate face_ids, so the faces are copied out first
+            leaf_slots old = leaves[leaf];
+            std::vector <int> leaf_faces(face_ids.begin() + old.begin, face_ids.begin() + old.begin + old.size);
+            leaves[leaf] = appendSlots(leaf_faces.data(), old.size, 2 * old.size + triangle_block::WIDTH);
+            numUnusedSlots += old.capacity;
+        }
+        hole = leaves[leaf].begin + leaves[leaf].size;
+        leaves[leaf].size += triangle_block::WIDTH;
+    }
+    setSlot(hole, id);
+    return numFaces + 1;
+}
+
+// Replaces the leaf by the subtree that building its cell from its faces gives, which splits the cell at least once
+void linear_quadtree::splitLeaf(const leaf_cell &cell)
+{
+    leaf_slots old = leaves[cell.leaf];
+    std::vector <int> cell_faces;
+    for (int slot = old.begin; slot < old.begin + old.size; slot++)
+    {
+        if (face_ids[slot] != -1)
+            cell_faces.push_back(face_ids[slot]);
+    }
+    leaf_buffer out;
+    build(cell_faces, cell.cx, cell.cy, cell.level, [&](int id){return faceBoundingBox(faces[id] -> invrot());}, 1, out);
+
+    std::vector <leaf_slots> new_leaves;
+    int next_id = 0;
+    for (int sz: out.sizes)
+    {
+        new_leaves.push_back(appendSlots(out.ids.data() + next_id, sz, 0));
+        next_id += sz;
+    }
+    numUnusedSlots += old.capacity;
+    leaf_codes.erase(leaf_codes.begin() + cell.leaf);
+    leaf_codes.insert(leaf_codes.begin() + cell.leaf, out.codes.begin(), out.codes.end());
+    leaves.erase(leaves.begin() + cell.leaf);
+    leaves.insert(leaves.begin() + cell.leaf, new_leaves.begin(), new_leaves.end());
+    depth = std::max(depth, out.depth);
+}
+
+// Packs the faces of every leaf into consecutive slots without holes or free slots
+void linear_quadtree::compact()
+{
+    std::vector <int> old_ids;
+    old_ids.swap(face_ids);
+    std::vector <triangle_block>().swap(blocks);
+    for (leaf_slots &slots: leaves)
+        slots = appendSlots(old_ids.data() + slots.begin, slots.size, 0);
+    numUnusedSlots = 0;
+}
+
+// face is a dual edge outwards from the face to insert, like in quadtree::insert
+// Each leaf is split after the face is added to it, from the last leaf to the first so that splitting does not move the leaves still to be visited
+void linear_quadtree::insert(edge* face)
+{
+    int id;
+    if (!free_ids.empty())
+    {
+        id = free_ids.back();
+        free_ids.pop_back();
+        faces[id] = face -> rot();
+    }
+    else
+    {
+        id = faces.size();
+        faces.push_back(face -> rot());
+    }
+
+    std::tuple <T, T, T, T> face_box = faceBoundingBox(face);
+    std::vector <leaf_cell> cells;
+    findLeaves(face_box, 0, 0, 0, cells);
+    for (auto cell = cells.rbegin(); cell != cells.rend(); ++cell)
+    {
+        if (!boxOverlapsFace(cellBounds(cell -> cx, cell -> cy, cell -> level), face, face_box))
+            continue;
+        int numFaces = addToLeaf(cell -> leaf, id);
+        if (numFaces == MAX_OVERLAP and cell -> level < std::min(MAX_DEPTH, codeDepth) and canSplit(cell -> cx, cell -> cy, cell -> level))
+            splitLeaf(*cell);
+    }
+    if (numUnusedSlots > face_ids.size() / 2)
+        compact();
+}
+
+// Takes every face in face_keys out of the leaves whose cells overlap face_box, like quadtree::remove
+// Faces are compared by pointer only, so the keys may belong to faces whose edges have already changed
+void linear_quadtree::remove(const std::vector <edge*> &face_keys, const std::tuple <T, T, T, T>& face_box)
+{
+    std::vector <leaf_cell> cells;
+    findLeaves(face_box, 0, 0, 0, cells);
+    // A face is in every leaf its box overlaps, so its id is free once these leaves no longer hold it
+    std::vector <int> removed_ids;
+    for (const leaf_cell &cell: cells)
+    {
+        for (int slot = leaves[cell.leaf].begin; slot < leaves[cell.leaf].begin + leaves[cell.leaf].size; slot++)
+        {
+            int id = face_ids[slot];
+            if (id == -1 or std::find(face_keys.begin(), face_keys.end(), faces[id] -> invrot()) == face_keys.end())
+                continue;
+            setSlot(slot, -1);
+            if (std::find(removed_ids.begin(), removed_ids.end(), id) == removed_ids.end())
+                removed_ids.push_back(id);
+        }
+    }
+    for (int id: removed_ids)
+    {
+        faces[id] = NULL;
+        free_ids.push_back(id);
+    }
+}
+
+/* Point Location */
+
+// Returns the code of the cell of the finest level that contains p, which must be inside the root cell
+// Points on the right or top boundary belong to the last cell
+unsigned long long linear_quadtree::pointCode(const point &p) const
+{
+    unsigned long long numCells = 1ULL << codeDepth;
+    unsigned long long cx = std::min((unsigned long long) ((p.x - left) / width * numCells), numCells - 1);
+    unsigned long long cy = std::min((unsigned long long) ((p.y - bottom) / height * numCells), numCells - 1);
+    // Rounding can put p one cell away from the cell whose bounds (as computed during construction) contain it
+    T cell_left, cell_top, cell_right, cell_bottom;
+    std::tie(cell_left, cell_top, cell_right, cell_bottom) = cellBounds(cx, cy, codeDepth);
+    if (p.x < cell_left and cx > 0) cx--;
+    else if (p.x > cell_right and cx + 1 < numCells) cx++;
+    if (p.y < cell_bottom and cy > 0) cy--;
+    else if (p.y > cell_top and cy + 1 < numCells) cy++;
+    return interleave(cx, cy);
+}
+
+edge* linear_quadtree::locate(const point &p, leafScanMode mode)
+{
+    if (leaf_codes.empty() or p.x < left or p.x > right or p.y < bottom or p.y > top)
+        return NULL;
+
+    unsigned long long code = pointCode(p);
+    int leaf = std::upper_bound(leaf_codes.begin(), leaf_codes.end(), code) - leaf_codes.begin() - 1;
+    int first_block = leaves[leaf].begin / triangle_block::WIDTH;
+    int numBlocks = leaves[leaf].size / triangle_block::WIDTH;
+    int index = findInBlocks(blocks.data() + first_block, numBlocks, p, mode);
+    return index == -1 ? NULL : faces[face_ids[leaves[leaf].begin + index]];
+}
+
+// Searches the leaf codes for BATCH_SIZE points at a time in lockstep, then prefetches the blocks of every leaf found before scanning any of them
+void linear_quadtree::locate_batch(const point* points, size_t numPoints, edge** located, leafScanMode mode)
+{
+    for (size_t first = 0; first < numPoints; first += BATCH_SIZE)
+    {
+        int numGroup = std::min((size_t) BATCH_SIZE, numPoints - first);
+        const point* p = points + first;
+        bool inside[BATCH_SIZE];
+        unsigned long long code[BATCH_SIZE];
+        int leaf[BATCH_SIZE], size[BATCH_SIZE];
+        for (int g = 0; g < numGroup; g++)
+        {
+            inside[g] = !(leaf_codes.empty() or p[g].x < left or p[g].x > right or p[g].y < bottom or p[g].y > top);
+            code[g] = inside[g] ? pointCode(p[g]) : 0;
+            leaf[g] = 0;
+            size[g] = inside[g] ? leaf_codes.size() : 1;
+        }
+        // The first leaf has code 0, so the last leaf whose code is at most the code of the point always exists
+        batchBinarySearch(numGroup, leaf, size, [&](int g, int i){return leaf_codes[i] <= code[g];}, [&](int, int i){__builtin_prefetch(&leaf_codes[i]);});
+
+        for (int g = 0; g < numGroup; g++)
+        {
+            if (inside[g] and leaves[leaf[g]].size > 0)
+                __builtin_prefetch(&blocks[leaves[leaf[g]].begin / triangle_block::WIDTH]);
+        }
+        for (int g = 0; g < numGroup; g++)
+        {
+            if (!inside[g])
+            {
+                located[first + g] = NULL;
+                continue;
+            }
+            int first_block = leaves[leaf[g]].begin / triangle_block::WIDTH;
+            int numBlocks = leaves[leaf[g]].size / triangle_block::WIDTH;
+            int index = findInBlocks(blocks.data() + first_block, numBlocks, p[g], mode);
+            located[first + g] = index == -1 ? NULL : faces[face_ids[leaves[leaf[g]].begin + index]];
+        }
+    }
+}
+
+// Returns the number of face references stored in the leaves (padding and holes excluded), matching quadtree::getNumNodes
+int linear_quadtree::getNumNodes()
+{
+    int numNodes = 0;
+    for (const leaf_slots &slots: leaves)
+        numNodes += std::count_if(face_ids.begin() + slots.begin, face_ids.begin() + slots.begin + slots.size, [](int id){return id != -1;});
+    return numNodes;
+}
+
+int linear_quadtree::getDepth()
+{
+    return depth;
+}
+
+// Returns the number of bytes used by the leaf codes, the CSR payload with its packed coordinates and the face table
+size_t linear_quadtree::getMemoryUsage()
+{
+    return leaf_codes.size() * sizeof(unsigned long long) + leaves.size() * sizeof(leaf_slots) + face_ids.size() * sizeof(int) +
+           blocks.size() * sizeof(triangle_block) + faces.size() * sizeof(edge*) + free_ids.size() * sizeof(int);
+}
@@ -1,41 +1,195 @@
 #include "point_location/non_walking/naive_quadtree.h"
 #include "planar_structure/plane.h"
+#include <algorithm>
+#include <thread>
 
-naive_quadtree::naive_quadtree(int overlapBound, int depthBound)
+naive_quadtree::naive_quadtree(int overlapBound, int depthBound, quadtreeBackend b, int threads)
 {
     MAX_OVERLAP = overlapBound;
     MAX_DEPTH = depthBound;
+    backend = b;
+    numThreads = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
 }
 
-void naive_quadtree::init(plane& pln)
+// Only changes how leaves are scanned, the quadtree itself stays the same
+void naive_quadtree::setLeafScan(leafScanMode mode)
 {
-    T box_left, box_top, box_right, box_bottom;
-    std::tie(box_left, box_top, box_right, box_bottom) = pln.bounds;
+    leafScan = mode;
+}
+
+void naive_quadtree::init(plane& p)
+{
+    pln = &p;
+    pending.clear();
+    build();
 
-    long long left = -1, top = 1, right = 1, bottom = -1;
-    while (left > box_left or top < box_top or right < box_right or bottom > box_bottom)
-        left *= 2, top *= 2, right *= 2, bottom *= 2;
+    auto dimension = getDimensions();
+    std::cout << "Quadtree Dimensions -> Num Nodes: " << dimension.first << " Depth: " << dimension.second << " Memory: " << getMemoryUsage() << " bytes" << std::endl;
+}
 
-    root = quadtree(std::make_tuple(left, top, right, bottom));
-    root.setParameters(MAX_OVERLAP, MAX_DEPTH);
+// Builds the quadtree of the chosen backend from every bounded face of the plane
+void naive_quadtree::build()
+{
+    // The root covers exactly the bounds of the mesh, so cells adapt to the scale of the coordinates
+    T left, top, right, bottom;
+    std::tie(left, top, right, bottom) = pln -> bounds;
 
-    for (edge* face: pln.traverse(dualGraph, traverseNodes))
+    std::vector <edge*> faces;
+    for (edge* face: pln -> traverse(dualGraph, traverseNodes))
     {
         if (face -> origin().getLabel() == 0) continue;
-        root.insert(face);
+        faces.push_back(face);
     }
 
-    auto dimension = getDimensions();
-    std::cout << "Quadtree Dimensions -> Num Nodes: " << dimension.first << " Depth: " << dimension.second << std::endl;
+    // Bounding boxes let the build skip most exact overlap tests, each thread fills its own contiguous chunk
+    std::vector <std::tuple <T, T, T, T>> face_boxes(faces.size());
+    std::vector <std::thread> workers;
+    int chunk = (faces.size() + numThreads - 1) / numThreads;
+    for (int t = 0; t < numThreads; t++)
+    {
+        workers.emplace_back([&, t]()
+        {
+            for (int i = t * chunk; i < std::min((t + 1) * chunk, (int) faces.size()); i++)
+                face_boxes[i] = faceBoundingBox(faces[i]);
+        });
+    }
+    for (std::thread &worker: workers)
+        worker.join();
+
+    if (backend == pointerQuadtree)
+    {
+        root = quadtree(std::make_tuple(left, top, right, bottom));
+        root.setParameters(MAX_OVERLAP, MAX_DEPTH);
+        root.build(faces, face_boxes, numThreads);
+    }
+    else
+    {
+        linear_root.setParameters(MAX_OVERLAP, MAX_DEPTH);
+        linear_root.init(std::make_tuple(left, top, right, bottom), faces, face_boxes, numThreads);
+    }
+}
+
+/* Online Updates */
+
+// Takes the left face of e out of the quadtree, if it is in it
+// Leaves store faces as the dual edge of one of their edges, so every edge of the face is a possible key
+void naive_quadtree::removeFace(edge* e)
+{
+    if (e -> leftfaceLabel() == 0) return;
+    std::vector <edge*> face_keys;
+    point first = e -> originPosition();
+    T left = first.x, top = first.y, right = first.x, bottom = first.y;
+    for (edge &face_edge: *e)
+    {
+        face_keys.push_back(face_edge.invrot());
+        point p = face_edge.originPosition();
+        left = std::min(left, p.x), right = std::max(right, p.x);
+        bottom = std::min(bottom, p.y), top = std::max(top, p.y);
+    }
+    if (backend == pointerQuadtree)
+        root.remove(face_keys, std::make_tuple(left, top, right, bottom));
+    else
+        linear_root.remove(face_keys, std::make_tuple(left, top, right, bottom));
+}
+
+// Called after e is added, both faces next to e have changed
+void naive_quadtree::addEdge(edge* e)
+{
+    removeFace(e);
+    removeFace(e -> twin());
+    pending.insert(e);
+    pending.insert(e -> twin());
+}
+
+// Called before e is removed, its faces are merged into the face of the edges that follow e on both sides
+void naive_quadtree::removeEdge(edge* e)
+{
+    removeFace(e);
+    removeFace(e -> twin());
+    pending.erase(e);
+    pending.erase(e -> twin());
+    if (e -> fnext() != e -> twin())
+        pending.insert(e -> fnext());
+    if (e -> twin() -> fnext() != e)
+        pending.insert(e -> twin() -> fnext());
+}
+
+// Inserts the current left face of every pending edge once
+// Assumes that every bounded face is a triangle again, like after a point is added to a triangulation
+void naive_quadtree::applyPendingUpdates()
+{
+    if (pending.empty()) return;
+
+    // A face is identified by its edge with the smallest address, so faces with several pending edges are inserted once
+    std::unordered_set <edge*> inserted;
+    for (edge* e: pending)
+    {
+        if (e -> leftfaceLabel() == 0) continue;
+        edge* smallest = e;
+        for (edge &face_edge: *e)
+            smallest = std::min(smallest, &face_edge);
+        if (!inserted.insert(smallest).second) continue;
+        if (backend == pointerQuadtree)
+            root.insert(smallest -> invrot());
+        else
+            linear_root.insert(smallest -> invrot());
+    }
+    pending.clear();
 }
 
 edge* naive_quadtree::locate(point p)
 {
-    return root.locate(p);
+    applyPendingUpdates();
+    if (backend == pointerQuadtree)
+        return root.locate(p, leafScan);
+    else
+        return linear_root.locate(p, leafScan);
+}
+
+// Locates the points in the quadtree as it is, without applying pending edits
+void naive_quadtree::searchBatch(const point* points, size_t numPoints, edge** located)
+{
+    if (backend == pointerQuadtree)
+        root.locate_batch(points, numPoints, located, leafScan);
+    else
+        linear_root.locate_batch(points, numPoints, located, leafScan);
 }
 
-// Returns number of nodes in quadtree along with the depth of the lowest node of the quadtree
+void naive_quadtree::locate_batch(const point* points, size_t numPoints, edge** located)
+{
+    applyPendingUpdates();
+    searchBatch(points, numPoints, located);
+}
+
+// Queries only read the quadtree, so pending edits are applied before threads start querying it
+std::unique_ptr <query_context> naive_quadtree::createQueryContext()
+{
+    applyPendingUpdates();
+    return nullptr;
+}
+
+// Threads may be querying the quadtree at the same time, so pending edits cannot be applied here
+void naive_quadtree::locate_batch_in_context(const point* points, size_t numPoints, edge** located, query_context*)
+{
+    if (!pending.empty())
+        throw pendingUpdatesException();
+    searchBatch(points, numPoints, located);
+}
+
+// Returns number of nodes in quadtree along with the depth of the lowest node of the quadtree, pending edits are not counted
 std::pair <int, int> naive_quadtree::getDimensions()
 {
-    return {root.getNumNodes(), root.getDepth()};
+    if (backend == pointerQuadtree)
+        return {root.getNumNodes(), root.getDepth()};
+    else
+        return {linear_root.getNumNodes(), linear_root.getDepth()};
+}
+
+// Returns the number of bytes used by the quadtree of the chosen backend
+size_t naive_quadtree::getMemoryUsage()
+{
+    if (backend == pointerQuadtree)
+        return root.getMemoryUsage();
+    else
+        return linear_root.getMemoryUsage();
 }
@@ -0,0 +1,20 @@
+#include "parallel/parallel_locate.h"
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+void locate_parallel(point_location &locator, const point* points, size_t numPoints, edge** located, work_stealing_pool &pool, size_t batchSize)
+{
+    // Contexts are created up front, since creating them can read state that queries of other threads modify
+    std::vector <std::unique_ptr <query_context>> contexts;
+    for (int t = 0; t < pool.getNumThreads(); t++)
+        contexts.push_back(locator.createQueryContext());
+
+    size_t numBatches = (numPoints + batchSize - 1) / batchSize;
+    pool.run(numBatches, [&](int thread, size_t batch)
+    {
+        size_t first = batch * batchSize;
+        size_t size = std::min(batchSize, numPoints - first);
+        locator.locate_batch_in_context(points + first, size, located + first, contexts[thread].get());
+    });
+}
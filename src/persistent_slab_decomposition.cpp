@@ -0,0 +1,234 @@
+#include "point_location/non_walking/persistent_slab_decomposition.h"
+#include "planar_structure/plane.h"
+#include <algorithm>
+#include <random>
+#include <assert.h>
+
+/* Persistent Treap */
+
+// Returns true if segment a is below segment b over the x-range they share
+// Only called on segments that are active in the same slab, so their x-ranges always overlap
+bool persistent_slab_decomposition::below(int a, int b) const
+{
+    point a_line[2] = {segments[a].left, segments[a].right};
+    point b_line[2] = {segments[b].left, segments[b].right};
+    return segmentAbove(b_line, a_line);
+}
+
+// Returns child side (0 below, 1 above) of node index as it was in the given version
+int persistent_slab_decomposition::childAt(int index, int side, int version) const
+{
+    const node &n = nodes[index];
+    if (n.modSide == side and n.modVersion <= version)
+        return n.modValue;
+    return n.child[side];
+}
+
+// Makes child (-1 for none) the child side of segment parent in the newest version, or the root if parent is -1
+// Only the live treap is changed, record stores the change in the versions afterwards
+void persistent_slab_decomposition::link(int parent, int side, int child)
+{
+    if (parent == -1)
+        liveRoot = child;
+    else
+        live[parent].child[side] = child;
+    if (child != -1)
+        live[child].parent = parent;
+}
+
+// Stores the live child side of segment seg in its node for the current version
+// A node of a finished version whose spare slot is taken is copied, and its parent is made to point to the copy the same way
+void persistent_slab_decomposition::record(int seg, int side)
+{
+    int version = versions.size();
+    int child = live[seg].child[side];
+    int value = child == -1 ? -1 : live[child].phys;
+    int index = live[seg].phys;
+    node &n = nodes[index];
+    // Nodes created while building the current version are not shared yet, so they are modified in place
+    if (index >= firstMutableNode)
+        n.child[side] = value;
+    else if (n.modSide == -1 or (n.modSide == side and n.modVersion == version))
+        n.modSide = side, n.modVersion = version, n.modValue = value;
+    else
+    {
+        node copy = {seg, {childAt(index, 0, version), childAt(index, 1, version)}, -1, 0, 0};
+        copy.child[side] = value;
+        nodes.push_back(copy);
+        live[seg].phys = nodes.size() - 1;
+        int parent = live[seg].parent;
+        if (parent != -1)
+            record(parent, live[parent].child[1] == seg);
+    }
+}
+
+// Rotates segment seg above its parent, keeping the order of the treap
+void persistent_slab_decomposition::rotateUp(int seg)
+{
+    int parent = live[seg].parent;
+    int grandparent = live[parent].parent;
+    int side = live[parent].child[1] == seg;
+    int grandparent_side = grandparent != -1 and live[grandparent].child[1] == parent;
+    // The live treap is made consistent first, so that copies made while recording reach the right parents
+    link(parent, side, live[seg].child[!side]);
+    link(seg, !side, parent);
+    link(grandparent, grandparent_side, seg);
+    record(parent, side);
+    record(seg, !side);
+    if (grandparent != -1)
+        record(grandparent, grandparent_side);
+}
+
+// Inserts segment seg as a leaf of the newest version and rotates it up while its priority is higher than its parent's
+void persistent_slab_decomposition::insert(int seg)
+{
+    int parent = -1, side = 0;
+    for (int curr = liveRoot; curr != -1; curr = live[curr].child[side])
+    {
+        parent = curr;
+        side = !below(seg, curr);
+    }
+    nodes.push_back({seg, {-1, -1}, -1, 0, 0});
+    live[seg].child[0] = live[seg].child[1] = -1;
+    live[seg].phys = nodes.size() - 1;
+    link(parent, side, seg);
+    if (parent != -1)
+        record(parent, side);
+    while (live[seg].parent != -1 and live[seg].priority > live[live[seg].parent].priority)
+        rotateUp(seg);
+}
+
+// Assumes that segment seg is in the newest version
+// Rotates seg down below its child of higher priority until it is a leaf, then detaches it
+void persistent_slab_decomposition::erase(int seg)
+{
+    while (live[seg].child[0] != -1 or live[seg].child[1] != -1)
+    {
+        int lower = live[seg].child[0], upper = live[seg].child[1];
+        if (upper == -1 or (lower != -1 and live[lower].priority > live[upper].priority))
+            rotateUp(lower);
+        else
+            rotateUp(upper);
+    }
+    int parent = live[seg].parent;
+    int side = parent != -1 and live[parent].child[1] == seg;
+    link(parent, side, -1);
+    if (parent != -1)
+        record(parent, side);
+}
+
+/* Persistent Slab Decomposition Implementation */
+
+// Sweeps a vertical line from left to right, creating a new version of the treap at every distinct x coordinate
+// Each segment is inserted and removed once, each update takes O(log n) expected time and adds O(1) expected nodes, so the build takes O(n log n) time and O(n) space
+void persistent_slab_decomposition::init(plane &p)
+{
+    segments.clear();
+    nodes.clear();
+    slab_positions.clear();
+    versions.clear();
+    std::mt19937 priorityGen;
+
+    std::vector <int> insertions, removals;
+    for (edge* e: p.traverse(primalGraph, traverseEdges))
+    {
+        point origin = e -> originPosition();
+        point destination = e -> destinationPosition();
+        // If origin is to the right of destination, flip the edge
+        if (origin > destination)
+        {
+            e = e -> twin();
+            std::swap(origin, destination);
+        }
+        slab_positions.push_back(origin.x);
+        slab_positions.push_back(destination.x);
+        // Vertical segments have no width, so they never separate faces inside a slab
+        if (origin.x == destination.x) continue;
+        insertions.push_back(segments.size());
+        removals.push_back(segments.size());
+        segments.push_back({origin, destination, e});
+    }
+    std::sort(slab_positions.begin(), slab_positions.end());
+    slab_positions.erase(std::unique(slab_positions.begin(), slab_positions.end()), slab_positions.end());
+    std::sort(insertions.begin(), insertions.end(), [&](int a, int b){return segments[a].left.x < segments[b].left.x;});
+    std::sort(removals.begin(), removals.end(), [&](int a, int b){return segments[a].right.x < segments[b].right.x;});
+
+    live.assign(segments.size(), live_node());
+    for (live_node &n: live)
+        n.priority = priorityGen();
+    liveRoot = -1;
+    int insert_it = 0, remove_it = 0;
+    for (T x: slab_positions)
+    {
+        firstMutableNode = nodes.size();
+        // Segments ending at x are removed before segments starting at x are inserted so that every segment in the treap spans the slab
+        while (remove_it < removals.size() and segments[removals[remove_it]].right.x == x)
+            erase(removals[remove_it++]);
+        while (insert_it < insertions.size() and segments[insertions[insert_it]].left.x == x)
+            insert(insertions[insert_it++]);
+        versions.push_back(liveRoot == -1 ? -1 : live[liveRoot].phys);
+    }
+    live.clear();
+    live.shrink_to_fit();
+    nodes.shrink_to_fit();
+
+    auto dimension = getDimensions();
+    std::cout << "Persistent Slab Decomposition Dimensions -> Num Slabs: " << dimension.first << " Num Nodes: " << dimension.second << " Memory: " << getMemoryUsage() << " bytes" << std::endl;
+}
+
+// Finds the index of the slab that p belongs to
+// If p is not contained in any slab, returns -1
+int persistent_slab_decomposition::findSlabIndex(point p)
+{
+    if (slab_positions.size() < 2 or p.x < slab_positions[0] or p.x > slab_positions.back()) return -1;
+    int index = std::upper_bound(slab_positions.begin(), slab_positions.end(), p.x) - slab_positions.begin() - 1;
+    // Points on the last x coordinate belong to the last slab with a positive width
+    return std::min(index, (int) slab_positions.size() - 2);
+}
+
+// Returns the highest segment of the slab that is below p (or passes through p)
+// Returns NULL if no such segment exists
+edge* persistent_slab_decomposition::findInSlab(int index, point p)
+{
+    edge* result = NULL;
+    int curr = versions[index];
+    while (curr != -1)
+    {
+        const segment &s = segments[nodes[curr].seg];
+        // p is above or on s, so s is a candidate and any better candidate must be higher
+        if (orientation(s.left, s.right, p) <= 0)
+        {
+            result = s.e;
+            curr = childAt(curr, 1, index);
+        }
+        else
+            curr = childAt(curr, 0, index);
+    }
+    return result;
+}
+
+// Returns pointer to some edge that belongs to the face that contains p
+// Returns NULL if p is outside the plane
+edge* persistent_slab_decomposition::locate(point p)
+{
+    int ind = findSlabIndex(p);
+    if (ind == -1) return NULL;
+
+    // Segments are directed from left to right, so the face above the bounding segment is its left face
+    edge* bounding_edge = findInSlab(ind, p);
+    if (bounding_edge == NULL or bounding_edge -> leftfaceLabel() == 0)
+        return NULL;
+    return bounding_edge;
+}
+
+// Returns number of slabs along with the number of treap nodes shared by all versions
+std::pair <int, int> persistent_slab_decomposition::getDimensions()
+{
+    return {versions.size(), nodes.size()};
+}
+
+// Returns the number of bytes used by the segments, treap nodes and slab positions
+size_t persistent_slab_decomposition::getMemoryUsage()
+{
+    return segments.size() * sizeof(segment) + nodes.size() * sizeof(node) + slab_positions.size() * sizeof(T) + versions.size() * sizeof(int);
+}
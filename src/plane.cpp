@@ -58,7 +58,7 @@ const int plane::INF = 1231231234;
 int plane::time = 1;
 
 /* Helper function for Calculating Bounding Box */
-plane::box plane::calculate_LTRB_bounding_box(std::vector <point> &points)
+plane::box plane::calculate_LTRB_bounding_box(const std::vector <point> &points)
 {
     T left, top, right, bottom;
     for (int i = 0; i < points.size(); i++)
@@ -91,13 +91,16 @@ edge* plane::make_polygon(std::vector <vertex*> &vertices, int face_number)
         edges[i] = makeEdge();
         edges[i] -> setEndpoints(vertices[i], vertices[inext], face, &extremeVertex);
     }
+    // Sum of the orientations of a fan of triangles from the first point, which is negative for ccw polygons even if they are not convex
+    T orientation_sum = 0;
     for (int i = 0; i < vertices.size(); i++)
     {
         int inext = nextIndex(i, vertices.size());
         splice(edges[inext], edges[i] -> twin());
-        // Check that points are in ccw order
-        assert(orientation(edges[i] -> originPosition(), edges[i] -> destinationPosition(), edges[inext] -> destinationPosition()) <= 0);
+        orientation_sum += orientation(edges[0] -> originPosition(), edges[i] -> originPosition(), edges[i] -> destinationPosition());
     }
+    // Check that points are in ccw order
+    assert(orientation_sum <= 0);
     return edges[0];
 }
 
@@ -128,6 +131,7 @@ edge* plane::init_bounding_box(const box &LTRB)
 // Assumes that all points are distinct and that the points of each face are given in ccw order
 edge* plane::init_subdivision(const std::vector <point> &points, const std::vector <std::vector<int>> &faces)
 {
+    bounds = calculate_LTRB_bounding_box(points);
     std::vector <vertex*> vertices(points.size());
     for (int i = 0; i < points.size(); i++)
     {
@@ -110,6 +110,23 @@ bool intersects(point2D m[2], point2D n[2])
     }
 }
 
+// Assumes that both segments are directed from their lexicographically smaller endpoint to their larger one
+// Assumes that m and n do not cross and that their x-ranges overlap (with a positive length)
+// Returns true if m is above n over the x-range they share
+// Points are compared lexicographically, which acts like a symbolic shear so vertical segments need no special handling
+bool segmentAbove(const point2D m[2], const point2D n[2])
+{
+    // Segments starting at the same point are ordered by slope
+    if (m[0] == n[0])
+        return orientation(n[0], n[1], m[1]) < 0;
+    // If m starts inside the x-range of n, its left endpoint cannot lie on n
+    else if (n[0] < m[0])
+        return orientation(n[0], n[1], m[0]) < 0;
+    // Otherwise n starts inside the x-range of m
+    else
+        return orientation(m[0], m[1], n[0]) > 0;
+}
+
 /* Point IO */
 
 std::istream& operator >> (std::istream &is, point2D &p)
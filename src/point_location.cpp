@@ -0,0 +1,25 @@
+#include "point_location/point_location.h"
+#include "quadedge_structure/edge.h"
+
+// Faces may be non-convex, so p can be on the line of an edge without being on the edge itself
+// Vertices are tested first, and p is only on an edge if it is strictly between its endpoints
+location classifyLocation(edge* e, point p)
+{
+    if (e == NULL)
+        return {outsidePlane, NULL};
+    edge* face_edge = e;
+    do
+    {
+        if (p == face_edge -> originPosition())
+            return {onVertex, face_edge};
+        face_edge = face_edge -> fnext();
+    } while (face_edge != e);
+    do
+    {
+        point a = face_edge -> originPosition(), b = face_edge -> destinationPosition();
+        if (orientation(a, b, p) == 0 and dot(p - a, b - a) > 0 and dot(p - b, a - b) > 0)
+            return {onEdge, face_edge};
+        face_edge = face_edge -> fnext();
+    } while (face_edge != e);
+    return {inFace, e};
+}
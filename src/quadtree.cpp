@@ -1,5 +1,7 @@
 #include "data_structures/quadtree.h"
 #include "quadedge_structure/quadedge.h"
+#include <thread>
+#include <algorithm>
 #include <assert.h>
 
 quadtree::quadtree(const std::tuple <T, T, T, T>& bounding_box, int lev)
@@ -23,49 +25,102 @@ bool quadtree::contains(const point &p)
     return p.x >= left and p.x <= right and p.y >= bottom and p.y <= top;
 }
 
-// face represents a dual edge outwards from the face we are checking for an overlap with this quadtree node
-bool quadtree::overlaps(edge* face)
+// A node can only be split while its midpoint is strictly inside it, so cells keep halving until double precision runs out
+bool quadtree::canSplit()
 {
-    bool triangleInsideSquare = true, squareInsideTriangle = true;
-    std::vector <edge*> face_edges;
+    T midx = (left + right) / 2;
+    T midy = (bottom + top) / 2;
+    return left < midx and midx < right and bottom < midy and midy < top;
+}
+
+/* Shared Geometry */
+
+// Returns the bounding box (left, top, right, bottom) of the face that face points out of
+std::tuple <T, T, T, T> faceBoundingBox(edge* face)
+{
+    point first = face -> rot() -> originPosition();
+    T left = first.x, top = first.y, right = first.x, bottom = first.y;
     for (auto it = face -> rot() -> begin(incidentOnFace); it != face -> rot() -> end(incidentOnFace); ++it)
     {
-        face_edges.push_back(&*it);
-        if (!contains(it -> originPosition()))
-            triangleInsideSquare = false;
+        point p = it -> originPosition();
+        left = std::min(left, p.x), right = std::max(right, p.x);
+        bottom = std::min(bottom, p.y), top = std::max(top, p.y);
     }
-    // If the face is strictly inside the square, they overlap
-    if (triangleInsideSquare)
-        return true;
+    return std::make_tuple(left, top, right, bottom);
+}
+
+// Returns true if the triangular face overlaps the closed box given as (left, top, right, bottom)
+bool boxOverlapsFace(const std::tuple <T, T, T, T>& bounding_box, edge* face)
+{
+    T left, top, right, bottom;
+    std::tie(left, top, right, bottom) = bounding_box;
 
+    point face_vertices[3];
+    int sz = 0;
+    for (auto it = face -> rot() -> begin(incidentOnFace); it != face -> rot() -> end(incidentOnFace); ++it)
+    {
+        // Make sure that the face is a triangle
+        assert(sz < 3);
+        face_vertices[sz++] = it -> originPosition();
+    }
     // Make sure that the face is a triangle
-    assert(face_edges.size() == 3);
+    assert(sz == 3);
     // Make sure that the face is oriented ccw
-    assert(orientation(face_edges[0] -> originPosition(), face_edges[1] -> originPosition(), face_edges[2] -> originPosition()) <= 0);
+    assert(orientation(face_vertices[0], face_vertices[1], face_vertices[2]) <= 0);
 
-    point corners[4] = {{(T) left, (T) top},
-                        {(T) left, (T) bottom},
-                        {(T) right, (T) bottom},
-                        {(T) right, (T) top}};
-    for (int i = 0; i < 4; i++)
+    // Both shapes are convex and closed, so they overlap iff neither an axis of the square nor an edge of the triangle separates them
+    // Every test is a comparison or an orientation, so shapes that only touch at a point still overlap
+    if (std::max({face_vertices[0].x, face_vertices[1].x, face_vertices[2].x}) < left or std::min({face_vertices[0].x, face_vertices[1].x, face_vertices[2].x}) > right or
+        std::max({face_vertices[0].y, face_vertices[1].y, face_vertices[2].y}) < bottom or std::min({face_vertices[0].y, face_vertices[1].y, face_vertices[2].y}) > top)
+        return false;
+    point corners[4] = {{left, top},
+                        {left, bottom},
+                        {right, bottom},
+                        {right, top}};
+    for (int j = 0; j < 3; j++)
     {
-        int inext = i + 1 < 4 ? i + 1 : 0;
-        point square_edge[2] = {corners[i], corners[inext]};
-        for (int j = 0; j < face_edges.size(); j++)
+        int jnext = j + 1 < 3 ? j + 1 : 0;
+        bool separates = true;
+        for (int i = 0; i < 4 and separates; i++)
         {
-            int jnext = j + 1 < face_edges.size() ? j + 1 : 0;
-            point face_edge[2] = {face_edges[j] -> originPosition(), face_edges[jnext] -> originPosition()};
-            if (intersects(face_edge, square_edge))
-                return true;
-            if (orientation(face_edge[0], face_edge[1], corners[i]) > 0)
-                squareInsideTriangle = false;
+            if (orientation(face_vertices[j], face_vertices[jnext], corners[i]) <= 0)
+                separates = false;
         }
+        if (separates)
+            return false;
     }
-    // If there are no intersections, they can only overlap if the square is strictly inside the triangle
-    return squareInsideTriangle;
+    return true;
 }
 
-void quadtree::split()
+// Same as boxOverlapsFace, but uses the bounding box of the face to skip the exact test whenever the answer is obvious
+bool boxOverlapsFace(const std::tuple <T, T, T, T>& bounding_box, edge* face, const std::tuple <T, T, T, T>& face_box)
+{
+    T left, top, right, bottom, face_left, face_top, face_right, face_bottom;
+    std::tie(left, top, right, bottom) = bounding_box;
+    std::tie(face_left, face_top, face_right, face_bottom) = face_box;
+    // Disjoint boxes cannot overlap
+    if (face_right < left or face_left > right or face_top < bottom or face_bottom > top)
+        return false;
+    // A face inside the box always overlaps it
+    if (face_left >= left and face_right <= right and face_bottom >= bottom and face_top <= top)
+        return true;
+    return boxOverlapsFace(bounding_box, face);
+}
+
+/* Pointer Quadtree */
+
+// face represents a dual edge outwards from the face we are checking for an overlap with this quadtree node
+bool quadtree::overlaps(edge* face)
+{
+    return boxOverlapsFace(std::make_tuple(left, top, right, bottom), face);
+}
+
+bool quadtree::overlaps(edge* face, const std::tuple <T, T, T, T>& face_box)
+{
+    return boxOverlapsFace(std::make_tuple(left, top, right, bottom), face, face_box);
+}
+
+void quadtree::createChildren()
 {
     T midx = (left + right) / 2;
     T midy = (bottom + top) / 2;
@@ -76,6 +131,11 @@ void quadtree::split()
     children[3] = new quadtree(std::make_tuple(midx, top, right, midy), level + 1);
     for (int i = 0; i < 4; i++)
         children[i] -> setParameters(MAX_OVERLAP, MAX_DEPTH);
+}
+
+void quadtree::split()
+{
+    createChildren();
 
     while (!faces.empty())
     {
@@ -87,6 +147,50 @@ void quadtree::split()
                 children[i] -> insert(face);
         }
     }
+    std::vector <triangle_block>().swap(blocks);
+}
+
+// Adds face to the faces of a leaf, keeping the packed coordinates in sync
+void quadtree::addToLeaf(edge* face)
+{
+    int lane = faces.size() % triangle_block::WIDTH;
+    if (lane == 0)
+        blocks.push_back(triangle_block());
+    blocks.back().set(lane, face -> rot());
+    faces.push_back(face);
+}
+
+// Packs the coordinates of every face of a leaf again, after faces were taken out of it
+void quadtree::packLeaf()
+{
+    std::vector <edge*> leaf_faces;
+    leaf_faces.swap(faces);
+    blocks.clear();
+    for (edge* face: leaf_faces)
+        addToLeaf(face);
+}
+
+// Takes every face in face_keys out of the leaves whose boxes overlap face_box
+// Faces are compared by pointer only, so the keys may belong to faces whose edges have already changed
+// Leaves are never merged, so the tree keeps the shape it had before the removal
+void quadtree::remove(const std::vector <edge*> &face_keys, const std::tuple <T, T, T, T>& face_box)
+{
+    T face_left, face_top, face_right, face_bottom;
+    std::tie(face_left, face_top, face_right, face_bottom) = face_box;
+    if (face_right < left or face_left > right or face_top < bottom or face_bottom > top)
+        return;
+
+    if (children[0] != NULL)
+    {
+        for (int i = 0; i < 4; i++)
+            children[i] -> remove(face_keys, face_box);
+        return;
+    }
+    auto is_key = [&](edge* face){return std::find(face_keys.begin(), face_keys.end(), face) != face_keys.end();};
+    size_t numFaces = faces.size();
+    faces.erase(std::remove_if(faces.begin(), faces.end(), is_key), faces.end());
+    if (faces.size() != numFaces)
+        packLeaf();
 }
 
 void quadtree::insert(edge* face)
@@ -101,17 +205,64 @@ void quadtree::insert(edge* face)
     }
     else
     {
-        faces.push_back(face);
-        if (faces.size() == MAX_OVERLAP and level < MAX_DEPTH)
+        addToLeaf(face);
+        if (faces.size() == MAX_OVERLAP and level < MAX_DEPTH and canSplit())
+            split();
+    }
+}
+
+// Builds the subtree of this node top down from the faces all_faces[id] for every id in ids
+// A node is split iff inserting the same faces one by one would have split it, so the result matches repeated insert calls
+// Subtrees of the top levels are built by separate threads, each thread owns the nodes it creates so no locking is needed
+void quadtree::buildNode(const std::vector <edge*> &all_faces, const std::vector <std::tuple <T, T, T, T>> &face_boxes, const std::vector <int> &ids, int numThreads)
+{
+    if (ids.size() < MAX_OVERLAP or level >= MAX_DEPTH or !canSplit())
+    {
+        for (int id: ids)
+            addToLeaf(all_faces[id]);
+        return;
+    }
+
+    createChildren();
+    auto build_child = [&](int i)
+    {
+        std::vector <int> child_ids;
+        for (int id: ids)
         {
-            // Only split if the current cell is not a 1x1 cell
-            if (right - left >= 2 and top - bottom >= 2)
-                split();
+            if (children[i] -> overlaps(all_faces[id], face_boxes[id]))
+                child_ids.push_back(id);
         }
+        children[i] -> buildNode(all_faces, face_boxes, child_ids, numThreads / 4);
+    };
+
+    if (numThreads > 1)
+    {
+        std::vector <std::thread> workers;
+        for (int i = 1; i < 4; i++)
+            workers.emplace_back(build_child, i);
+        build_child(0);
+        for (std::thread &worker: workers)
+            worker.join();
+    }
+    else
+    {
+        for (int i = 0; i < 4; i++)
+            build_child(i);
     }
 }
 
-edge* quadtree::locate(const point &p)
+// Assumes that the node is empty
+// face_boxes[i] is the bounding box of all_faces[i], it is only used to skip exact overlap tests
+void quadtree::build(const std::vector <edge*> &all_faces, const std::vector <std::tuple <T, T, T, T>> &face_boxes, int numThreads)
+{
+    assert(children[0] == NULL and faces.empty());
+    std::vector <int> ids(all_faces.size());
+    for (int id = 0; id < ids.size(); id++)
+        ids[id] = id;
+    buildNode(all_faces, face_boxes, ids, numThreads);
+}
+
+edge* quadtree::locate(const point &p, leafScanMode mode)
 {
     if (children[0] != NULL)
     {
@@ -119,29 +270,62 @@ edge* quadtree::locate(const point &p)
         {
             if (children[i] -> contains(p))
             {
-                return children[i] -> locate(p);
+                return children[i] -> locate(p, mode);
             }
         }
         return NULL;
     }
     else
     {
-        for (edge* face: faces)
+        // Faces of a leaf are tested through their packed coordinates, without touching the edges
+        int index = findInBlocks(blocks.data(), blocks.size(), p, mode);
+        return index == -1 ? NULL : faces[index] -> rot();
+    }
+}
+
+// Descends with BATCH_SIZE points at a time, one level per round
+// Children of every node reached are prefetched, so the next round can test them while the misses of the other points are still pending
+void quadtree::locate_batch(const point* points, size_t numPoints, edge** located, leafScanMode mode)
+{
+    for (size_t first = 0; first < numPoints; first += BATCH_SIZE)
+    {
+        int numGroup = std::min((size_t) BATCH_SIZE, numPoints - first);
+        const point* p = points + first;
+        quadtree* node[BATCH_SIZE];
+        for (int g = 0; g < numGroup; g++)
+            node[g] = this;
+        bool active = children[0] != NULL;
+        while (active)
         {
-            bool allLeftTurns = true;
-            for (auto it = face -> rot() -> begin(incidentOnFace); it != face -> rot() -> end(incidentOnFace); ++it)
+            active = false;
+            for (int g = 0; g < numGroup; g++)
             {
-                // If edge forms a right turn with p, it cannot belong to the face containing p
-                if (orientation(it -> originPosition(), it -> destinationPosition(), p) > 0)
+                if (node[g] == NULL or node[g] -> children[0] == NULL) continue;
+                quadtree* next = NULL;
+                for (int i = 0; i < 4 and next == NULL; i++)
                 {
-                    allLeftTurns = false;
-                    break;
+                    if (node[g] -> children[i] -> contains(p[g]))
+                        next = node[g] -> children[i];
                 }
+                node[g] = next;
+                if (next == NULL) continue;
+                if (next -> children[0] != NULL)
+                {
+                    for (int i = 0; i < 4; i++)
+                        __builtin_prefetch(next -> children[i]);
+                    active = true;
+                }
+                else if (!next -> blocks.empty())
+                    __builtin_prefetch(next -> blocks.data());
             }
-            if (allLeftTurns)
-                return face -> rot();
         }
-        return NULL;
+
+        // Faces of a leaf are tested through their packed coordinates, without touching the edges
+        for (int g = 0; g < numGroup; g++)
+        {
+            int index = node[g] == NULL ? -1 : findInBlocks(node[g] -> blocks.data(), node[g] -> blocks.size(), p[g], mode);
+            located[first + g] = index == -1 ? NULL : node[g] -> faces[index] -> rot();
+        }
     }
 }
 
@@ -172,3 +356,15 @@ int quadtree::getDepth()
         return d;
     }
 }
+
+// Returns the number of bytes used by the nodes of the quadtree and the face lists stored in them
+size_t quadtree::getMemoryUsage()
+{
+    size_t sz = sizeof(quadtree) + faces.capacity() * sizeof(edge*) + blocks.capacity() * sizeof(triangle_block);
+    if (children[0] != NULL)
+    {
+        for (int i = 0; i < 4; i++)
+            sz += children[i] -> getMemoryUsage();
+    }
+    return sz;
+}
@@ -1,9 +1,57 @@
 #include "point_location/non_walking/slab_decomposition.h"
 #include "planar_structure/plane.h"
+#include "data_structures/batch_search.h"
 #include <set>
 #include <algorithm>
+#include <functional>
+#include <limits>
 #include <assert.h>
 #include <iostream>
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+/* SIMD Helper Functions */
+
+// Returns the number of the B keys of a node that are at most x
+// Keys of a node are sorted and padded with infinity, so the keys that are at most x always form a prefix of the node
+static inline int countAtMost(const T* keys, T x)
+{
+#if defined(__AVX2__)
+    __m256d le = _mm256_cmp_pd(_mm256_loadu_pd(keys), _mm256_set1_pd(x), _CMP_LE_OQ);
+    return __builtin_popcount(_mm256_movemask_pd(le));
+#elif defined(__SSE2__)
+    __m128d xs = _mm_set1_pd(x);
+    int mask = _mm_movemask_pd(_mm_cmple_pd(_mm_loadu_pd(keys), xs)) | (_mm_movemask_pd(_mm_cmple_pd(_mm_loadu_pd(keys + 2), xs)) << 2);
+    return __builtin_popcount(mask);
+#else
+    int count = 0;
+    for (int i = 0; i < 4; i++)
+        count += keys[i] <= x;
+    return count;
+#endif
+}
+
+// Returns the number of the B lines of a node whose height at x is at most y
+static inline int countBelow(const T* slopes, const T* intercepts, T x, T y)
+{
+#if defined(__AVX2__)
+    __m256d heights = _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(slopes), _mm256_set1_pd(x)), _mm256_loadu_pd(intercepts));
+    __m256d le = _mm256_cmp_pd(heights, _mm256_set1_pd(y), _CMP_LE_OQ);
+    return __builtin_popcount(_mm256_movemask_pd(le));
+#elif defined(__SSE2__)
+    __m128d xs = _mm_set1_pd(x), ys = _mm_set1_pd(y);
+    __m128d low = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(slopes), xs), _mm_loadu_pd(intercepts));
+    __m128d high = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(slopes + 2), xs), _mm_loadu_pd(intercepts + 2));
+    int mask = _mm_movemask_pd(_mm_cmple_pd(low, ys)) | (_mm_movemask_pd(_mm_cmple_pd(high, ys)) << 2);
+    return __builtin_popcount(mask);
+#else
+    int count = 0;
+    for (int i = 0; i < 4; i++)
+        count += slopes[i] * x + intercepts[i] <= y;
+    return count;
+#endif
+}
 
 /* Event Functions */
 
@@ -16,26 +64,172 @@ point slab_decomposition::event::position() const
         return segment -> destinationPosition();
 }
 
-// Comparator for two edge pointers that compares the y coordinate of their left endpoints
-// Used to sort segments within a slab
+// Orders events from left to right, with removals coming before insertions at the same x coordinate
+// Removing first ensures that every segment in the sweep line spans the whole slab that starts at that x coordinate
 bool slab_decomposition::event::operator < (const event &o) const
 {
-    return position() < o.position();
+    T x = position().x, o_x = o.position().x;
+    if (x != o_x) return x < o_x;
+    else return isLeft < o.isLeft;
 }
 
 /* Slab Decomposition Implementation */
 
-void slab_decomposition::init(plane &p)
+slab_decomposition::slab_decomposition(slabSearchLayout sl)
 {
-    slabs.clear();
-    slab_positions.clear();
+    layout = sl;
+}
 
+// Returns, for every slot of a static B-tree holding n sorted keys, the index of the key stored in that slot (-1 for padding)
+// Node k is stored in slots [k * B, (k + 1) * B) and its i-th child is node k * (B + 1) + i + 1
+std::vector <int> slab_decomposition::btreeOrder(int n)
+{
+    int numBlocks = (n + B - 1) / B;
+    std::vector <int> order(numBlocks * B, -1);
+    int next_key = 0;
+    // In-order traversal of the implicit tree hands out keys in sorted order
+    std::function <void(int)> fill = [&](int k)
+    {
+        if (k >= numBlocks) return;
+        for (int i = 0; i < B; i++)
+        {
+            fill(k * (B + 1) + i + 1);
+            if (next_key < n)
+                order[k * B + i] = next_key++;
+        }
+        fill(k * (B + 1) + B + 1);
+    };
+    fill(0);
+    return order;
+}
+
+// Appends a slab whose segments are given from bottom to top
+void slab_decomposition::addSlab(const std::vector <edge*> &slab_edges)
+{
+    auto line_of = [](edge* e)
+    {
+        point a = e -> originPosition(), b = e -> destinationPosition();
+        T slope = (b.y - a.y) / (b.x - a.x);
+        return line{slope, a.y - slope * a.x};
+    };
+
+    size_t begin = segments.size();
+    if (layout == sortedLayout)
+    {
+        for (edge* e: slab_edges)
+        {
+            lines.push_back(line_of(e));
+            segments.push_back(e);
+        }
+    }
+    else
+    {
+        std::vector <int> order = btreeOrder(slab_edges.size());
+        for (int slot = 0; slot < order.size(); slot++)
+        {
+            if (slot % B == 0)
+                line_blocks.push_back(line_block());
+            line_block &block = line_blocks.back();
+            // Padding lines are infinitely high, so they are never below a query point
+            line l = order[slot] == -1 ? line{0, std::numeric_limits<T>::infinity()} : line_of(slab_edges[order[slot]]);
+            block.slope[slot % B] = l.slope;
+            block.intercept[slot % B] = l.intercept;
+            segments.push_back(order[slot] == -1 ? NULL : slab_edges[order[slot]]);
+        }
+    }
+    slabs.push_back({begin, segments.size() - begin, segments.size() - begin});
+}
+
+// Appends a slab for every position, holding the segments that span it from bottom to top
+// Segments must be directed from left to right and not be vertical, segments starting left of the first position are in the first slab
+void slab_decomposition::sweepSlabs(const std::vector <edge*> &slab_segments, const std::vector <T> &positions)
+{
     // Each event is a pair corresponding to the position of a vertex and the edge it belongs to, from left to right
     // Events will be used to line sweep from left to right and create slabs for each distinct pair of consecutive x-coordinates
     std::vector <event> events;
-    std::vector <int> x_coordinates;
+    for (edge* e: slab_segments)
+    {
+        events.push_back({e, true});
+        events.push_back({e, false});
+    }
+    std::sort(events.begin(), events.end());
+
+    // Comparator for two edge pointers that compares the segments by height over the x-range they share
+    // Segments in the sweep line never cross, so their order does not change while they are both in the sweep line
+    auto compareByY = [](edge* a, edge* b)
+    {
+        point a_line[2] = {a -> originPosition(), a -> destinationPosition()};
+        point b_line[2] = {b -> originPosition(), b -> destinationPosition()};
+        return segmentAbove(b_line, a_line);
+    };
+
+    // Slabs can hold O(n^2) segments in total, so the flat arrays of a new decomposition are sized exactly before they are filled
+    if (segments.empty())
+    {
+        size_t numSegments = 0, numActive = 0;
+        for (int i = 0, event_it = 0; i < positions.size(); i++)
+        {
+            for (; event_it < events.size() and events[event_it].position().x <= positions[i]; ++event_it)
+            {
+                if (events[event_it].isLeft) numActive++;
+                else numActive--;
+            }
+            // Slabs in the B-tree layout are padded to a multiple of B
+            numSegments += layout == sortedLayout ? numActive : (numActive + B - 1) / B * B;
+        }
+        if (layout == sortedLayout)
+            lines.reserve(numSegments);
+        else
+            line_blocks.reserve(numSegments / B);
+        segments.reserve(numSegments);
+        slabs.reserve(positions.size());
+    }
+
+    int event_it = 0;
+    std::set <edge*, decltype(compareByY)> current_slab(compareByY);
+    for (int i = 0; i < positions.size(); i++)
+    {
+        while (event_it < events.size() and events[event_it].position().x <= positions[i])
+        {
+            // Left endpoints represent insertion events
+            if (events[event_it].isLeft)
+                current_slab.insert(events[event_it].segment);
+            // Right endpoints represent removal events
+            else
+                current_slab.erase(events[event_it].segment);
+            ++event_it;
+        }
+        addSlab(std::vector <edge*>(current_slab.begin(), current_slab.end()));
+    }
+}
 
-    std::vector <edge*> edges = p.traverse(primalGraph, traverseEdges);
+void slab_decomposition::buildPositionTree()
+{
+    position_tree.clear();
+    position_indices.clear();
+    if (layout == btreeLayout)
+    {
+        for (int index: btreeOrder(slab_positions.size()))
+        {
+            position_tree.push_back(index == -1 ? std::numeric_limits<T>::infinity() : slab_positions[index]);
+            position_indices.push_back(index);
+        }
+    }
+}
+
+void slab_decomposition::init(plane &p)
+{
+    // Swap with empty vectors so that the memory of a previous decomposition is released
+    std::vector <line>().swap(lines);
+    std::vector <line_block>().swap(line_blocks);
+    std::vector <edge*>().swap(segments);
+    slabs.clear();
+    slab_positions.clear();
+    added_edges.clear();
+    removed_edges.clear();
+    dirty_ranges.clear();
+
+    std::vector <edge*> edges = p.traverse(primalGraph, traverseEdges), slab_segments;
     for (int i = 0; i < edges.size(); i++)
     {
         point origin = edges[i] -> originPosition();
@@ -46,117 +240,462 @@ void slab_decomposition::init(plane &p)
             edges[i] = edges[i] -> twin();
             std::swap(origin, destination);
         }
-        events.push_back({edges[i], true});
-        events.push_back({edges[i], false});
-        x_coordinates.push_back(origin.x);
-        x_coordinates.push_back(destination.x);
+        slab_positions.push_back(origin.x);
+        slab_positions.push_back(destination.x);
+        // Vertical segments have no width, so they never separate faces inside a slab
+        if (origin.x == destination.x) continue;
+        slab_segments.push_back(edges[i]);
     }
-    std::sort(events.begin(), events.end());
-    std::sort(x_coordinates.begin(), x_coordinates.end());
-    x_coordinates.erase(std::unique(x_coordinates.begin(), x_coordinates.end()), x_coordinates.end());
+    std::sort(slab_positions.begin(), slab_positions.end());
+    slab_positions.erase(std::unique(slab_positions.begin(), slab_positions.end()), slab_positions.end());
+
+    sweepSlabs(slab_segments, slab_positions);
+    buildPositionTree();
+
+    auto dimension = getDimensions();
+    std::cout << "Slab Decomposition Dimensions -> Num Slabs: " << dimension.first << " Num Stored Segments: " << dimension.second << " Memory: " << getMemoryUsage() << " bytes" << std::endl;
+}
 
-    // Comparator for two edge pointers that compares the y coordinate of their left endpoints
-    // Used to sort segments within a slab
-    auto compareByY = [](const event &a, const event &b)
+/* Online Updates */
+
+void slab_decomposition::addEdge(edge* e)
+{
+    added_edges.insert(e);
+}
+
+// Called before e is removed, so its endpoints can still be read
+void slab_decomposition::removeEdge(edge* e)
+{
+    T x1 = e -> originPosition().x, x2 = e -> destinationPosition().x;
+    dirty_ranges.push_back({std::min(x1, x2), std::max(x1, x2)});
+    removed_edges.insert(e);
+    removed_edges.insert(e -> twin());
+    added_edges.erase(e);
+    added_edges.erase(e -> twin());
+}
+
+// Sets the number of slots of the segment array (and of the line array of the layout)
+void slab_decomposition::resizeStorage(size_t numSlots)
+{
+    if (layout == sortedLayout)
+        lines.resize(numSlots);
+    else
+        line_blocks.resize(numSlots / B);
+    segments.resize(numSlots);
+}
+
+// Copies count slots starting at from to the slots starting at to, which must not overlap them
+void slab_decomposition::moveSlots(size_t from, size_t to, size_t count)
+{
+    if (layout == sortedLayout)
+        std::copy(lines.begin() + from, lines.begin() + from + count, lines.begin() + to);
+    else
+        std::copy(line_blocks.begin() + from / B, line_blocks.begin() + (from + count) / B, line_blocks.begin() + to / B);
+    std::copy(segments.begin() + from, segments.begin() + from + count, segments.begin() + to);
+}
+
+// Stores the slabs back to back again, without free slots
+void slab_decomposition::compactStorage()
+{
+    std::vector <line> old_lines;
+    std::vector <line_block> old_blocks;
+    std::vector <edge*> old_segments;
+    old_lines.swap(lines);
+    old_blocks.swap(line_blocks);
+    old_segments.swap(segments);
+
+    size_t numUsed = 0;
+    for (const slab_storage &slab: slabs)
+        numUsed += slab.size;
+    if (layout == sortedLayout)
+        lines.reserve(numUsed);
+    else
+        line_blocks.reserve(numUsed / B);
+    segments.reserve(numUsed);
+
+    for (slab_storage &slab: slabs)
     {
-        point a_pos = a.position();
-        point b_pos = b.position();
+        size_t begin = segments.size();
+        if (layout == sortedLayout)
+            lines.insert(lines.end(), old_lines.begin() + slab.begin, old_lines.begin() + slab.begin + slab.size);
+        else
+            line_blocks.insert(line_blocks.end(), old_blocks.begin() + slab.begin / B, old_blocks.begin() + (slab.begin + slab.size) / B);
+        segments.insert(segments.end(), old_segments.begin() + slab.begin, old_segments.begin() + slab.begin + slab.size);
+        slab = {begin, slab.size, slab.size};
+    }
+}
+
+// Sweeps every run of consecutive slabs that overlaps an edited x-range again, the other slabs are not touched
+// A run starts from the segments its slabs already have, without the removed edges and with the added edges, so only the mesh around the edits is read
+// Endpoints of added edges become new slab positions, positions are never removed (slabs without a vertex only cost memory)
+// Apart from rebuilding the position tree, an update costs time proportional to the segments of the runs, plus the amortized cost of compacting
+void slab_decomposition::applyPendingUpdates()
+{
+    if (added_edges.empty() and removed_edges.empty()) return;
 
-        if (a_pos.y != b_pos.y) return a_pos.y < b_pos.y;
-        else if (a_pos.x != b_pos.x) return a_pos.x < b_pos.x;
-        else return a.segment < b.segment;
+    std::vector <edge*> added;
+    std::vector <T> positions = slab_positions;
+    for (edge* e: added_edges)
+    {
+        if (e -> originPosition() > e -> destinationPosition())
+            e = e -> twin();
+        T left = e -> originPosition().x, right = e -> destinationPosition().x;
+        dirty_ranges.push_back({left, right});
+        positions.push_back(left);
+        positions.push_back(right);
+        if (left != right)
+            added.push_back(e);
+    }
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+    // Merge the edited ranges, so that every slab can be checked with one binary search
+    std::sort(dirty_ranges.begin(), dirty_ranges.end());
+    std::vector <std::pair <T, T>> ranges;
+    for (auto &range: dirty_ranges)
+    {
+        if (!ranges.empty() and range.first <= ranges.back().second)
+            ranges.back().second = std::max(ranges.back().second, range.second);
+        else
+            ranges.push_back(range);
+    }
+    int numSlabs = slab_positions.size();
+    auto slab_right = [&](int i){return i + 1 < numSlabs ? slab_positions[i + 1] : slab_positions[i];};
+    auto is_affected = [&](int i)
+    {
+        auto range = std::lower_bound(ranges.begin(), ranges.end(), slab_positions[i], [](const std::pair <T, T> &r, T x){return r.second < x;});
+        return range != ranges.end() and range -> first <= slab_right(i);
     };
 
-    int event_it = 0;
-    std::set <event, decltype(compareByY)> current_slab(compareByY);
-    for (int i = 0; i < x_coordinates.size(); i++)
+    std::vector <slab_storage> old_slabs;
+    old_slabs.swap(slabs);
+    slabs.reserve(positions.size());
+
+    for (int i = 0; i < numSlabs; )
     {
-        while (event_it < events.size() and events[event_it].position().x == x_coordinates[i])
+        if (!is_affected(i))
         {
-            // Left endpoints represent insertion events
-            if (events[event_it].isLeft)
-                current_slab.insert(events[event_it]);
-            // Right endpoints represent removal events
-            else
-                current_slab.erase(events[event_it]);
-            ++event_it;
+            slabs.push_back(old_slabs[i]);
+            i++;
+            continue;
+        }
+
+        int last = i;
+        while (last + 1 < numSlabs and is_affected(last + 1))
+            last++;
+        T run_left = slab_positions[i], run_right = slab_right(last);
+        bool is_last_run = last + 1 == numSlabs;
+
+        // Removed edges are only compared by address, since they may already be deleted
+        std::unordered_set <edge*> seen;
+        std::vector <edge*> run_segments;
+        for (int j = i; j <= last; j++)
+        {
+            for (size_t k = old_slabs[j].begin; k < old_slabs[j].begin + old_slabs[j].size; k++)
+            {
+                edge* e = segments[k];
+                if (e != NULL and removed_edges.count(e) == 0 and seen.insert(e).second)
+                    run_segments.push_back(e);
+            }
+        }
+        for (edge* e: added)
+        {
+            if (e -> originPosition().x < run_right and e -> destinationPosition().x > run_left and seen.insert(e).second)
+                run_segments.push_back(e);
+        }
+        auto first_position = std::lower_bound(positions.begin(), positions.end(), run_left);
+        auto end_position = is_last_run ? positions.end() : std::lower_bound(positions.begin(), positions.end(), run_right);
+        // The new slabs are appended, then moved over the old slots of the run if those are consecutive and have room for them
+        size_t run_begin = segments.size();
+        int first_slab = slabs.size();
+        sweepSlabs(run_segments, std::vector <T>(first_position, end_position));
+        size_t run_size = segments.size() - run_begin;
+
+        bool is_consecutive = true;
+        for (int j = i; j < last; j++)
+            is_consecutive = is_consecutive and old_slabs[j].begin + old_slabs[j].capacity == old_slabs[j + 1].begin;
+        size_t old_begin = old_slabs[i].begin, old_end = old_slabs[last].begin + old_slabs[last].capacity;
+        if (is_consecutive and run_size <= old_end - old_begin)
+        {
+            moveSlots(run_begin, old_begin, run_size);
+            resizeStorage(run_begin);
+            for (int j = first_slab; j < slabs.size(); j++)
+                slabs[j].begin -= run_begin - old_begin;
+            slabs.back().capacity = old_end - slabs.back().begin;
         }
-        std::vector <edge*> slab_edges;
-        for (event e: current_slab)
+        else
         {
-            slab_edges.push_back(e.segment);
+            // Room for the run to grow by a quarter, so that the next edits around it are written in place
+            size_t slack = (run_size / 4 + B - 1) / B * B;
+            resizeStorage(segments.size() + slack);
+            slabs.back().capacity += slack;
         }
-        slabs.push_back(slab_edges);
-        slab_positions.push_back(x_coordinates[i]);
+        i = last + 1;
     }
+    slab_positions.swap(positions);
+    buildPositionTree();
+
+    // Slots of moved runs are never reused, so the storage is compacted once most of it is unused
+    size_t numUsed = 0;
+    for (const slab_storage &slab: slabs)
+        numUsed += slab.size;
+    if (segments.size() > 2 * numUsed)
+        compactStorage();
+
+    added_edges.clear();
+    removed_edges.clear();
+    dirty_ranges.clear();
 }
 
 // Finds the index of the slab that p belongs to
 // If p is not contained in any slab, returns -1
 int slab_decomposition::findSlabIndex(point p)
 {
-    if (p.x < slab_positions[0] or p.x > slab_positions.back()) return -1;
+    if (slab_positions.size() < 2 or p.x < slab_positions[0] or p.x > slab_positions.back()) return -1;
 
-    int l = 0, r = slab_positions.size() - 1;
-    while (l < r)
+    // Find the last slab that starts at or before p
+    int l = 0;
+    if (layout == sortedLayout)
     {
-        int m = (l + r) / 2;
-        if (p.x < slab_positions[m])
-            r = m - 1;
-        else if (!(m + 1 < slabs.size()) or p.x <= slab_positions[m + 1])
-            return m;
-        else
-            l = m + 1;
+        int r = slab_positions.size() - 1;
+        while (l < r)
+        {
+            int m = (l + r + 1) / 2;
+            if (slab_positions[m] <= p.x)
+                l = m;
+            else
+                r = m - 1;
+        }
+    }
+    else
+    {
+        // Every node visited holds keys larger than the ones of the previous candidate, so the last candidate is the answer
+        int numBlocks = position_tree.size() / B;
+        for (int k = 0; k < numBlocks; )
+        {
+            int count = countAtMost(&position_tree[k * B], p.x);
+            if (count > 0)
+                l = position_indices[k * B + count - 1];
+            k = k * (B + 1) + count + 1;
+        }
     }
-    return l;
+    // Points on the last x coordinate belong to the last slab with a positive width
+    return std::min(l, (int) slab_positions.size() - 2);
 }
 
+// Returns the highest segment of the slab that is below p (or passes through p)
+// Segments are compared by their height at the x coordinate of p
+// Returns NULL if no such segment exists
 edge* slab_decomposition::findInSlab(int index, point p)
 {
-    // Returns the y-coordinate of an edges left endpoint
-    // Assumes that e is directed from left to right
-    // Used to detect if point is above/below edge since we know edges don't intersect within a slab
-    auto getY = [](edge* e)
-    {
-        return e -> originPosition().y;
-    };
-
-    assert(p.x >= slab_positions[index]);
-    assert(index + 1 >= slab_positions.size() or p.x <= slab_positions[index + 1]);
+    assert(p.x >= slab_positions[index] and p.x <= slab_positions[index + 1]);
 
-    if (p.y < getY(slabs[index][0]) or p.y > getY(slabs[index].back()))
-        return NULL;
+    if (layout == btreeLayout)
+    {
+        // Blocks of the slab are nodes of a static B-tree, the highest line below p found on the way down is the answer
+        size_t first_block = slabs[index].begin / B;
+        int numBlocks = slabs[index].size / B;
+        edge* result = NULL;
+        for (int k = 0; k < numBlocks; )
+        {
+            const line_block &block = line_blocks[first_block + k];
+            int count = countBelow(block.slope, block.intercept, p.x, p.y);
+            if (count > 0)
+                result = segments[(first_block + k) * B + count - 1];
+            k = k * (B + 1) + count + 1;
+        }
+        return result;
+    }
 
-    int l = 0, r = slabs[index].size() - 1;
+    // Find the number of segments in the slab that are below p
+    size_t l = slabs[index].begin, r = slabs[index].begin + slabs[index].size;
     while (l < r)
     {
-        int m = (l + r) / 2;
-
-        if (p.y < getY(slabs[index][m]))
-            r = m - 1;
-        else if (!( m + 1 < slabs[index].size()) or p.y <= getY(slabs[index][m + 1]))
-            return slabs[index][m];
-        else
+        size_t m = l + (r - l) / 2;
+        if (lines[m].y(p.x) <= p.y)
             l = m + 1;
+        else
+            r = m;
     }
-    return slabs[index][l];
+    if (l == slabs[index].begin) return NULL;
+    else return segments[l - 1];
 }
 
+// Returns pointer to some edge that belongs to the face that contains p
+// Returns NULL if p is outside the plane
 edge* slab_decomposition::locate(point p)
 {
+    applyPendingUpdates();
     int ind = findSlabIndex(p);
     if (ind == -1) return NULL;
 
+    // Segments are directed from left to right, so the face above the bounding segment is its left face
     edge* bounding_edge = findInSlab(ind, p);
-
-    if (bounding_edge == NULL)
+    if (bounding_edge == NULL or bounding_edge -> leftfaceLabel() == 0)
         return NULL;
+    return bounding_edge;
+}
 
-    point origin = bounding_edge -> originPosition();
-    point destination = bounding_edge -> destinationPosition();
+// Same as findSlabIndex for each of the numPoints points, with the searches of all points running in lockstep
+void slab_decomposition::findSlabIndices(const point* p, int numPoints, int* index)
+{
+    int numSlabs = slab_positions.size();
+    for (int g = 0; g < numPoints; g++)
+        index[g] = (numSlabs < 2 or p[g].x < slab_positions[0] or p[g].x > slab_positions.back()) ? -1 : 0;
 
-    if (orientation(origin, destination, p) > 0)
-        return bounding_edge -> twin();
+    if (layout == sortedLayout)
+    {
+        int size[BATCH_SIZE];
+        for (int g = 0; g < numPoints; g++)
+            size[g] = index[g] == -1 ? 1 : numSlabs;
+        const T* keys = slab_positions.data();
+        batchBinarySearch(numPoints, index, size, [&](int g, int i){return keys[i] <= p[g].x;}, [&](int, int i){__builtin_prefetch(keys + i);});
+    }
     else
-        return bounding_edge;
+    {
+        int numBlocks = position_tree.size() / B;
+        int node[BATCH_SIZE];
+        for (int g = 0; g < numPoints; g++)
+            node[g] = index[g] == -1 ? numBlocks : 0;
+        bool active = true;
+        while (active)
+        {
+            active = false;
+            for (int g = 0; g < numPoints; g++)
+            {
+                if (node[g] >= numBlocks) continue;
+                int count = countAtMost(&position_tree[node[g] * B], p[g].x);
+                if (count > 0)
+                    index[g] = position_indices[node[g] * B + count - 1];
+                node[g] = node[g] * (B + 1) + count + 1;
+                if (node[g] < numBlocks)
+                {
+                    __builtin_prefetch(&position_tree[node[g] * B]);
+                    active = true;
+                }
+            }
+        }
+    }
+
+    // Points on the last x coordinate belong to the last slab with a positive width
+    for (int g = 0; g < numPoints; g++)
+    {
+        if (index[g] != -1)
+            index[g] = std::min(index[g], numSlabs - 2);
+    }
+}
+
+// Same as findInSlab for each of the numPoints points (NULL for points outside every slab), with the searches of all points running in lockstep
+void slab_decomposition::findInSlabs(const point* p, int numPoints, const int* index, edge** result)
+{
+    if (layout == btreeLayout)
+    {
+        size_t first_block[BATCH_SIZE];
+        int numBlocks[BATCH_SIZE], node[BATCH_SIZE];
+        for (int g = 0; g < numPoints; g++)
+        {
+            result[g] = NULL;
+            node[g] = 0;
+            first_block[g] = index[g] == -1 ? 0 : slabs[index[g]].begin / B;
+            numBlocks[g] = index[g] == -1 ? 0 : slabs[index[g]].size / B;
+            if (numBlocks[g] > 0)
+                __builtin_prefetch(&line_blocks[first_block[g]]);
+        }
+        bool active = true;
+        while (active)
+        {
+            active = false;
+            for (int g = 0; g < numPoints; g++)
+            {
+                if (node[g] >= numBlocks[g]) continue;
+                const line_block &block = line_blocks[first_block[g] + node[g]];
+                int count = countBelow(block.slope, block.intercept, p[g].x, p[g].y);
+                if (count > 0)
+                    result[g] = segments[(first_block[g] + node[g]) * B + count - 1];
+                node[g] = node[g] * (B + 1) + count + 1;
+                if (node[g] < numBlocks[g])
+                {
+                    __builtin_prefetch(&line_blocks[first_block[g] + node[g]]);
+                    active = true;
+                }
+            }
+        }
+        return;
+    }
+
+    size_t base[BATCH_SIZE], size[BATCH_SIZE];
+    for (int g = 0; g < numPoints; g++)
+    {
+        base[g] = index[g] == -1 ? 0 : slabs[index[g]].begin;
+        size[g] = index[g] == -1 ? 0 : slabs[index[g]].size;
+    }
+    batchBinarySearch(numPoints, base, size, [&](int g, size_t i){return lines[i].y(p[g].x) <= p[g].y;}, [&](int, size_t i){__builtin_prefetch(&lines[i]);});
+    for (int g = 0; g < numPoints; g++)
+    {
+        // base is the highest segment below p, unless no segment of the slab is below p
+        bool below = size[g] > 0 and lines[base[g]].y(p[g].x) <= p[g].y;
+        result[g] = below ? segments[base[g]] : NULL;
+    }
+}
+
+// Locates the points in groups of BATCH_SIZE, each step of a search prefetches what the next step of the same search reads
+// The searches of a group take turns, so that their cache misses overlap instead of adding up
+// Pending edits are not applied, callers make sure that there are none
+void slab_decomposition::searchBatch(const point* points, size_t numPoints, edge** located)
+{
+    for (size_t first = 0; first < numPoints; first += BATCH_SIZE)
+    {
+        int numGroup = std::min((size_t) BATCH_SIZE, numPoints - first);
+        const point* p = points + first;
+        int index[BATCH_SIZE];
+        edge* bounding_edge[BATCH_SIZE];
+        findSlabIndices(p, numGroup, index);
+        findInSlabs(p, numGroup, index, bounding_edge);
+
+        for (int g = 0; g < numGroup; g++)
+        {
+            if (bounding_edge[g] != NULL)
+                __builtin_prefetch(bounding_edge[g]);
+        }
+        // Segments are directed from left to right, so the face above the bounding segment is its left face
+        for (int g = 0; g < numGroup; g++)
+            located[first + g] = (bounding_edge[g] == NULL or bounding_edge[g] -> leftfaceLabel() == 0) ? NULL : bounding_edge[g];
+    }
+}
+
+// Queries only read the slabs, so pending edits are applied before threads start querying them
+std::unique_ptr <query_context> slab_decomposition::createQueryContext()
+{
+    applyPendingUpdates();
+    return nullptr;
+}
+
+void slab_decomposition::locate_batch(const point* points, size_t numPoints, edge** located)
+{
+    applyPendingUpdates();
+    searchBatch(points, numPoints, located);
+}
+
+// Threads may be querying the slabs at the same time, so pending edits cannot be applied here
+void slab_decomposition::locate_batch_in_context(const point* points, size_t numPoints, edge** located, query_context*)
+{
+    if (!added_edges.empty() or !removed_edges.empty())
+        throw pendingUpdatesException();
+    searchBatch(points, numPoints, located);
+}
+
+// Returns number of slabs along with the total number of segments stored across all slabs, pending edits are not counted
+std::pair <int, size_t> slab_decomposition::getDimensions()
+{
+    size_t numStored = 0;
+    for (const slab_storage &slab: slabs)
+        numStored += slab.size;
+    return {slab_positions.size(), numStored};
+}
+
+// Returns the number of bytes used by the slabs (free slots included) and their positions
+size_t slab_decomposition::getMemoryUsage()
+{
+    return lines.size() * sizeof(line) + line_blocks.size() * sizeof(line_block) + segments.size() * sizeof(edge*) + slabs.size() * sizeof(slab_storage) +
+           slab_positions.size() * sizeof(T) + position_tree.size() * sizeof(T) + position_indices.size() * sizeof(int);
 }
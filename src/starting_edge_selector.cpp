@@ -2,6 +2,7 @@
 #include "planar_structure/plane.h"
 #include <random>
 #include <ctime>
+#include <algorithm>
 #include <assert.h>
 
 starting_edge_selector::starting_edge_selector(selectorMode sm, unsigned int sampleSize)
@@ -19,6 +20,14 @@ void starting_edge_selector::setPlane(plane &pl)
 {
     edgeList.clear();
     validEdges.clear();
+    if (mode == selectGrid)
+    {
+        T right, top;
+        std::tie(gridLeft, top, right, gridBottom) = pl.bounds;
+        gridWidth = right - gridLeft;
+        gridHeight = top - gridBottom;
+        resizeGrid(1, 1);
+    }
     for (edge* e: pl.traverse(primalGraph, traverseEdges))
         addEdge(e);
 }
@@ -27,11 +36,22 @@ void starting_edge_selector::addEdge(edge* e)
 {
     edgeList.push_back(e);
     validEdges.insert(e);
+    if (mode == selectGrid)
+    {
+        addToGrid(e);
+        if (validEdges.size() > GRID_EDGES_PER_CELL * grid.size())
+            resizeGrid(2 * gridColumns, 2 * gridRows);
+    }
 }
 
+// Must be called before e is deleted or moved, since the grid is searched using its endpoints
 void starting_edge_selector::removeEdge(edge* e)
 {
+    // Edges may be removed through the twin of the edge that was added
     validEdges.erase(e);
+    validEdges.erase(e -> twin());
+    if (mode == selectGrid)
+        removeFromGrid(e);
 }
 
 void starting_edge_selector::locatedEdge(edge* e)
@@ -40,23 +60,29 @@ void starting_edge_selector::locatedEdge(edge* e)
 }
 
 edge* starting_edge_selector::getStartingEdge(point p)
+{
+    return getStartingEdge(p, recentEdge, gen);
+}
+
+edge* starting_edge_selector::getStartingEdge(point p, edge* recent, std::mt19937 &generator) const
 {
     // Iff not using the best edge out of a sample to start, sampleSize must zero
     assert((mode == selectSample) ^ (sampleSize == 0));
 
-    if (mode == selectRecent and recentEdge != NULL)
-        return recentEdge;
+    if (mode == selectRecent and recent != NULL)
+        return recent;
     else if(mode == selectSample)
-        return bestFromSample(p);
+        return bestFromSample(p, generator);
+    else if(mode == selectGrid)
+        return nearestFromGrid(p);
     else
         return *validEdges.begin();
 }
 
-edge* starting_edge_selector::bestFromSample(point p)
+edge* starting_edge_selector::bestFromSample(point p, std::mt19937 &generator) const
 {
     assert(edgeList.size() > 0);
 
-    std::mt19937 gen{static_cast<unsigned int>(time(0))};
     std::uniform_int_distribution <int> dist(0, edgeList.size() - 1);
 
     edge* closestEdge = NULL;
@@ -67,7 +93,7 @@ edge* starting_edge_selector::bestFromSample(point p)
         edge* curr;
         while (!foundEdge)
         {
-            int randomIndex = dist(gen);
+            int randomIndex = dist(generator);
             if (validEdges.count(edgeList[randomIndex]) == 1)
             {
                 curr = edgeList[randomIndex];
@@ -87,3 +113,82 @@ edge* starting_edge_selector::bestFromSample(point p)
     }
     return closestEdge;
 }
+
+/* Grid Helpers */
+
+// Returns the index of the cell containing p, points outside the grid are clamped to its border cells
+int starting_edge_selector::gridCell(point p) const
+{
+    T x = gridWidth > 0 ? (p.x - gridLeft) / gridWidth * gridColumns : 0;
+    T y = gridHeight > 0 ? (p.y - gridBottom) / gridHeight * gridRows : 0;
+    int column = x < 0 ? 0 : x >= gridColumns ? gridColumns - 1 : (int) x;
+    int row = y < 0 ? 0 : y >= gridRows ? gridRows - 1 : (int) y;
+    return row * gridColumns + column;
+}
+
+// Rebuilds the grid with the given number of cells from every valid edge
+void starting_edge_selector::resizeGrid(int columns, int rows)
+{
+    gridColumns = columns;
+    gridRows = rows;
+    grid.assign(columns * rows, NULL);
+    for (edge* e: validEdges)
+        addToGrid(e);
+}
+
+// Makes e represent the cell of its origin and its twin represent the cell of its destination, so every cell with a vertex has an edge
+void starting_edge_selector::addToGrid(edge* e)
+{
+    grid[gridCell(e -> originPosition())] = e;
+    grid[gridCell(e -> destinationPosition())] = e -> twin();
+}
+
+// Hands the cells that e represents over to another valid edge out of the same vertex, so flips do not empty the cells of the vertices they touch
+// Cells are only left empty when e was the last valid edge of its endpoint
+void starting_edge_selector::removeFromGrid(edge* e)
+{
+    for (edge* endpoint: {e, e -> twin()})
+    {
+        int cell = gridCell(endpoint -> originPosition());
+        if (grid[cell] != e and grid[cell] != e -> twin()) continue;
+        grid[cell] = NULL;
+        for (edge* other = endpoint -> onext(); other != endpoint; other = other -> onext())
+        {
+            if (validEdges.count(other) == 1 or validEdges.count(other -> twin()) == 1)
+            {
+                grid[cell] = other;
+                break;
+            }
+        }
+    }
+}
+
+// Returns the edge of the cell containing p
+// If that cell has no edge, returns an edge of the closest non-empty cell, searching rings of cells around it
+edge* starting_edge_selector::nearestFromGrid(point p) const
+{
+    assert(grid.size() > 0 and validEdges.size() > 0);
+
+    int cell = gridCell(p);
+    if (grid[cell] != NULL)
+        return grid[cell];
+
+    int column = cell % gridColumns, row = cell / gridColumns;
+    auto at = [&](int c, int r) -> edge*
+    {
+        if (c < 0 or c >= gridColumns or r < 0 or r >= gridRows) return NULL;
+        return grid[r * gridColumns + c];
+    };
+    for (int radius = 1; radius < std::max(gridColumns, gridRows); radius++)
+    {
+        for (int d = -radius; d <= radius; d++)
+        {
+            for (edge* e: {at(column + d, row - radius), at(column + d, row + radius), at(column - radius, row + d), at(column + radius, row + d)})
+            {
+                if (e != NULL)
+                    return e;
+            }
+        }
+    }
+    return *validEdges.begin();
+}
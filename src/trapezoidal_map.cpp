@@ -0,0 +1,241 @@
+#include "point_location/non_walking/trapezoidal_map.h"
+#include "planar_structure/plane.h"
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <stack>
+#include <assert.h>
+
+/* Helper Functions */
+
+// Returns the left (even index) or right (odd index) endpoint of a segment, used for xNodes
+point trapezoidal_map::endpoint(int index) const
+{
+    const segment &s = segments[index / 2];
+    return index % 2 == 0 ? s.left : s.right;
+}
+
+// Assumes that s and t do not cross and that their x-ranges overlap (with a positive length)
+// Returns true if s is above t over the x-range they share
+bool trapezoidal_map::isAbove(const segment &s, const segment &t)
+{
+    point s_line[2] = {s.left, s.right}, t_line[2] = {t.left, t.right};
+    return segmentAbove(s_line, t_line);
+}
+
+// Returns an edge of a bounded face next to segment s, preferring the face below it
+// Returns NULL if both faces next to s are the outer face
+edge* trapezoidal_map::boundedSide(const segment &s)
+{
+    if (s.e -> twin() -> leftfaceLabel() != 0)
+        return s.e -> twin();
+    if (s.e -> leftfaceLabel() != 0)
+        return s.e;
+    return NULL;
+}
+
+/* Trapezoidal Map Construction */
+
+// Returns the trapezoids crossed by segment index, sorted from left to right
+// Every node of the search structure whose region intersects the segment is visited, so no neighbor pointers are needed
+std::vector <int> trapezoidal_map::crossedTrapezoids(int index)
+{
+    const segment &s = segments[index];
+    std::vector <int> result;
+    std::stack <int> node_stack;
+    node_stack.push(0);
+    while (!node_stack.empty())
+    {
+        int curr_index = node_stack.top();
+        node_stack.pop();
+        // Nodes can be shared by several parents, so each one is only processed once
+        if (lastVisited[curr_index] == index) continue;
+        lastVisited[curr_index] = index;
+
+        const node &curr = nodes[curr_index];
+        switch (curr.type)
+        {
+            case leafNode:
+                result.push_back(curr.index);
+                break;
+            case xNode:
+            {
+                point p = endpoint(curr.index);
+                if (s.left < p)
+                    node_stack.push(curr.child[0]);
+                if (p < s.right)
+                    node_stack.push(curr.child[1]);
+                break;
+            }
+            case yNode:
+            {
+                // The region of a yNode lies within the x-range of its segment, so segments that only touch that range at an endpoint can be skipped
+                const segment &t = segments[curr.index];
+                if (!(s.left < t.right and t.left < s.right))
+                    break;
+                node_stack.push(isAbove(s, t) ? curr.child[0] : curr.child[1]);
+                break;
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(), [&](int a, int b){return trapezoids[a].leftp < trapezoids[b].leftp;});
+    return result;
+}
+
+// Splits every trapezoid crossed by segment index into the part above and below it
+// Parts on the same side are merged whenever the wall between two crossed trapezoids is cut off by the segment
+void trapezoidal_map::insertSegment(int index)
+{
+    const segment s = segments[index];
+    std::vector <int> crossed = crossedTrapezoids(index);
+    assert(!crossed.empty());
+
+    auto make_trapezoid = [&](int top, int bottom, point leftp, point rightp)
+    {
+        nodes.push_back({leafNode, (int) trapezoids.size(), {-1, -1}});
+        trapezoids.push_back({top, bottom, leftp, rightp, (int) nodes.size() - 1});
+        return (int) trapezoids.size() - 1;
+    };
+
+    const trapezoid first = trapezoids[crossed.front()];
+    const trapezoid last = trapezoids[crossed.back()];
+    int left_part = -1, right_part = -1;
+    if (first.leftp < s.left)
+        left_part = make_trapezoid(first.top, first.bottom, first.leftp, s.left);
+    if (s.right < last.rightp)
+        right_part = make_trapezoid(last.top, last.bottom, s.right, last.rightp);
+
+    std::vector <int> above(crossed.size()), below(crossed.size());
+    above[0] = make_trapezoid(first.top, index, s.left, s.right);
+    below[0] = make_trapezoid(index, first.bottom, s.left, s.right);
+    for (int j = 1; j < crossed.size(); j++)
+    {
+        const trapezoid prev = trapezoids[crossed[j - 1]];
+        const trapezoid curr = trapezoids[crossed[j]];
+        point wall = prev.rightp;
+        // If the wall point is above the segment, the wall below it ends at the segment so the parts above must be split
+        if (orientation(s.left, s.right, wall) < 0)
+        {
+            trapezoids[above[j - 1]].rightp = wall;
+            above[j] = make_trapezoid(curr.top, index, wall, s.right);
+            below[j] = below[j - 1];
+        }
+        else
+        {
+            trapezoids[below[j - 1]].rightp = wall;
+            below[j] = make_trapezoid(index, curr.bottom, wall, s.right);
+            above[j] = above[j - 1];
+        }
+    }
+
+    // Replace the leaf of each crossed trapezoid by a subtree that splits it
+    for (int j = 0; j < crossed.size(); j++)
+    {
+        int leaf = trapezoids[crossed[j]].leaf;
+        node replacement = {yNode, index, {trapezoids[above[j]].leaf, trapezoids[below[j]].leaf}};
+        if (j + 1 == crossed.size() and right_part != -1)
+        {
+            nodes.push_back(replacement);
+            replacement = {xNode, 2 * index + 1, {(int) nodes.size() - 1, trapezoids[right_part].leaf}};
+        }
+        if (j == 0 and left_part != -1)
+        {
+            nodes.push_back(replacement);
+            replacement = {xNode, 2 * index, {trapezoids[left_part].leaf, (int) nodes.size() - 1}};
+        }
+        nodes[leaf] = replacement;
+        trapezoids[crossed[j]].leaf = -1;
+    }
+}
+
+// Assumes that segments of the plane only intersect at their endpoints
+// Works for any planar subdivision, faces do not need to be triangles or convex
+// Segments are inserted in random order so that the expected size is O(n) and the expected query time is O(log n)
+void trapezoidal_map::init(plane &pln)
+{
+    segments.clear();
+    trapezoids.clear();
+    nodes.clear();
+    lastVisited.clear();
+
+    for (edge* e: pln.traverse(primalGraph, traverseEdges))
+    {
+        point origin = e -> originPosition();
+        point destination = e -> destinationPosition();
+        // Direct each segment from left to right so that its left face is above it
+        if (origin > destination)
+        {
+            e = e -> twin();
+            std::swap(origin, destination);
+        }
+        segments.push_back({origin, destination, e});
+    }
+    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
+    std::shuffle(segments.begin(), segments.end(), std::mt19937(seed));
+
+    // Start with a single unbounded trapezoid covering the whole plane
+    const T inf = std::numeric_limits<T>::infinity();
+    nodes.push_back({leafNode, 0, {-1, -1}});
+    trapezoids.push_back({-1, -1, point(-inf, -inf), point(inf, inf), 0});
+
+    for (int i = 0; i < segments.size(); i++)
+    {
+        lastVisited.resize(nodes.size(), -1);
+        insertSegment(i);
+    }
+    lastVisited.clear();
+    lastVisited.shrink_to_fit();
+
+    auto dimension = getDimensions();
+    std::cout << "Trapezoidal Map Dimensions -> Num Trapezoids: " << dimension.first << " Num Nodes: " << dimension.second << " Memory: " << getMemoryUsage() << " bytes" << std::endl;
+}
+
+/* Point Location */
+
+// Returns pointer to some edge that belongs to the face that contains p
+// Returns NULL if p is outside the plane
+// Points on a segment or at an endpoint belong to both faces next to it, so they are resolved into a bounded one as soon as the search meets that segment
+//      (otherwise ties would always go right or below, which is the outer face on the right and top sides of the plane)
+edge* trapezoidal_map::locate(point p)
+{
+    int curr = 0;
+    while (nodes[curr].type != leafNode)
+    {
+        const node &n = nodes[curr];
+        const segment &s = segments[n.type == xNode ? n.index / 2 : n.index];
+        if (n.type == xNode)
+        {
+            point q = endpoint(n.index);
+            if (p == q and boundedSide(s) != NULL)
+                return boundedSide(s);
+            curr = p < q ? n.child[0] : n.child[1];
+        }
+        else
+        {
+            // The region of a yNode lies within the x-range of its segment, so p is on the segment if it is on its line
+            T side = orientation(s.left, s.right, p);
+            if (side == 0 and boundedSide(s) != NULL)
+                return boundedSide(s);
+            curr = side < 0 ? n.child[0] : n.child[1];
+        }
+    }
+    // The face containing the trapezoid is the face above its bottom segment
+    int bottom = trapezoids[nodes[curr].index].bottom;
+    if (bottom == -1) return NULL;
+    edge* e = segments[bottom].e;
+    if (e -> leftfaceLabel() == 0) return NULL;
+    return e;
+}
+
+// Returns number of trapezoids (including ones replaced during construction) along with the number of nodes in the search structure
+std::pair <int, int> trapezoidal_map::getDimensions()
+{
+    return {trapezoids.size(), nodes.size()};
+}
+
+// Returns the number of bytes used by the segments, trapezoids and search structure
+size_t trapezoidal_map::getMemoryUsage()
+{
+    return segments.size() * sizeof(segment) + trapezoids.size() * sizeof(trapezoid) + nodes.size() * sizeof(node);
+}
@@ -0,0 +1,105 @@
+#include "data_structures/triangle_block.h"
+#include "quadedge_structure/quadedge.h"
+#include <limits>
+#include <assert.h>
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+triangle_block::triangle_block()
+{
+    const T nan = std::numeric_limits<T>::quiet_NaN();
+    for (int i = 0; i < WIDTH; i++)
+        ax[i] = ay[i] = bx[i] = by[i] = cx[i] = cy[i] = nan;
+}
+
+// Stores the left face of e, which must be a triangle, in the given lane
+void triangle_block::set(int lane, edge* e)
+{
+    assert(lane >= 0 and lane < WIDTH);
+    point vertices[3];
+    int sz = 0;
+    for (auto it = e -> begin(incidentOnFace); it != e -> end(incidentOnFace); ++it)
+    {
+        // Make sure that the face is a triangle
+        assert(sz < 3);
+        vertices[sz++] = it -> originPosition();
+    }
+    assert(sz == 3);
+    ax[lane] = vertices[0].x, ay[lane] = vertices[0].y;
+    bx[lane] = vertices[1].x, by[lane] = vertices[1].y;
+    cx[lane] = vertices[2].x, cy[lane] = vertices[2].y;
+}
+
+// Makes the lane unused again
+void triangle_block::clear(int lane)
+{
+    assert(lane >= 0 and lane < WIDTH);
+    const T nan = std::numeric_limits<T>::quiet_NaN();
+    ax[lane] = ay[lane] = bx[lane] = by[lane] = cx[lane] = cy[lane] = nan;
+}
+
+// Every orientation below is computed exactly like orientation(a, b, p) = cross(p - a, b - a), so all scan modes agree with each other and with the walking locators
+int findInBlocks(const triangle_block* blocks, int numBlocks, const point &p, leafScanMode mode)
+{
+#if defined(__AVX2__)
+    if (mode == simdScan)
+    {
+        __m256d px = _mm256_set1_pd(p.x), py = _mm256_set1_pd(p.y), zero = _mm256_setzero_pd();
+        auto not_right_of = [&](__m256d ax, __m256d ay, __m256d bx, __m256d by)
+        {
+            __m256d o = _mm256_sub_pd(_mm256_mul_pd(_mm256_sub_pd(px, ax), _mm256_sub_pd(by, ay)), _mm256_mul_pd(_mm256_sub_pd(py, ay), _mm256_sub_pd(bx, ax)));
+            return _mm256_cmp_pd(o, zero, _CMP_LE_OQ);
+        };
+        for (int i = 0; i < numBlocks; i++)
+        {
+            const triangle_block &b = blocks[i];
+            __m256d ax = _mm256_loadu_pd(b.ax), ay = _mm256_loadu_pd(b.ay);
+            __m256d bx = _mm256_loadu_pd(b.bx), by = _mm256_loadu_pd(b.by);
+            __m256d cx = _mm256_loadu_pd(b.cx), cy = _mm256_loadu_pd(b.cy);
+            __m256d inside = _mm256_and_pd(_mm256_and_pd(not_right_of(ax, ay, bx, by), not_right_of(bx, by, cx, cy)), not_right_of(cx, cy, ax, ay));
+            int mask = _mm256_movemask_pd(inside);
+            if (mask)
+                return i * triangle_block::WIDTH + __builtin_ctz(mask);
+        }
+        return -1;
+    }
+#elif defined(__SSE2__)
+    if (mode == simdScan)
+    {
+        __m128d px = _mm_set1_pd(p.x), py = _mm_set1_pd(p.y), zero = _mm_setzero_pd();
+        auto not_right_of = [&](__m128d ax, __m128d ay, __m128d bx, __m128d by)
+        {
+            __m128d o = _mm_sub_pd(_mm_mul_pd(_mm_sub_pd(px, ax), _mm_sub_pd(by, ay)), _mm_mul_pd(_mm_sub_pd(py, ay), _mm_sub_pd(bx, ax)));
+            return _mm_cmple_pd(o, zero);
+        };
+        for (int i = 0; i < numBlocks; i++)
+        {
+            const triangle_block &b = blocks[i];
+            for (int half = 0; half < triangle_block::WIDTH; half += 2)
+            {
+                __m128d ax = _mm_loadu_pd(b.ax + half), ay = _mm_loadu_pd(b.ay + half);
+                __m128d bx = _mm_loadu_pd(b.bx + half), by = _mm_loadu_pd(b.by + half);
+                __m128d cx = _mm_loadu_pd(b.cx + half), cy = _mm_loadu_pd(b.cy + half);
+                __m128d inside = _mm_and_pd(_mm_and_pd(not_right_of(ax, ay, bx, by), not_right_of(bx, by, cx, cy)), not_right_of(cx, cy, ax, ay));
+                int mask = _mm_movemask_pd(inside);
+                if (mask)
+                    return i * triangle_block::WIDTH + half + __builtin_ctz(mask);
+            }
+        }
+        return -1;
+    }
+#endif
+    for (int i = 0; i < numBlocks; i++)
+    {
+        const triangle_block &b = blocks[i];
+        for (int lane = 0; lane < triangle_block::WIDTH; lane++)
+        {
+            point va(b.ax[lane], b.ay[lane]), vb(b.bx[lane], b.by[lane]), vc(b.cx[lane], b.cy[lane]);
+            // Comparisons are written so that NaN padding is never reported as containing p
+            if (orientation(va, vb, p) <= 0 and orientation(vb, vc, p) <= 0 and orientation(vc, va, p) <= 0)
+                return i * triangle_block::WIDTH + lane;
+        }
+    }
+    return -1;
+}
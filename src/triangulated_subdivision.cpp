@@ -0,0 +1,185 @@
+#include "point_location/non_walking/triangulated_subdivision.h"
+#include "planar_structure/plane.h"
+#include <algorithm>
+#include <assert.h>
+#include <iostream>
+
+// Plane of the triangles clipped from the faces, which only triangulated_subdivision can build
+struct triangulated_subdivision::hidden_plane : public plane
+{
+    void init(const std::vector <point> &points, const std::vector <std::vector <int>> &faces)
+    {
+        init_subdivision(points, faces);
+    }
+};
+
+triangulated_subdivision::triangulated_subdivision(std::unique_ptr <point_location> &l)
+{
+    locator = std::move(l);
+}
+
+triangulated_subdivision::~triangulated_subdivision() = default;
+
+static long long edgeKey(int origin, int destination)
+{
+    return ((long long) origin << 32) | (unsigned int) destination;
+}
+
+/* Ear Clipping */
+
+// Appends the triangles of the simple polygon given by the indices of its points in ccw order
+// An ear is a strictly convex corner whose triangle has no other point of the polygon inside or on it, so clipped triangles never hide a vertex on their edges
+// Every simple polygon with more than 3 points has an ear, so scanning the corners in order finds the next ear within O(k) tries and the polygon is clipped in O(k^3) worst case time
+void triangulated_subdivision::clipEars(const std::vector <point> &points, const std::vector <int> &polygon, std::vector <std::vector <int>> &triangles)
+{
+    int n = polygon.size();
+    std::vector <int> prev(n), next(n);
+    for (int i = 0; i < n; i++)
+    {
+        prev[i] = (i + n - 1) % n;
+        next[i] = (i + 1) % n;
+    }
+    auto corner = [&](int i){return points[polygon[i]];};
+    auto is_ear = [&](int i)
+    {
+        point a = corner(prev[i]), b = corner(i), c = corner(next[i]);
+        if (orientation(a, b, c) >= 0) return false;
+        for (int j = next[next[i]]; j != prev[i]; j = next[j])
+        {
+            point p = corner(j);
+            if (p == a or p == b or p == c) continue;
+            if (orientation(a, b, p) <= 0 and orientation(b, c, p) <= 0 and orientation(c, a, p) <= 0)
+                return false;
+        }
+        return true;
+    };
+
+    int remaining = n, i = 0, numTries = 0;
+    while (remaining > 3)
+    {
+        if (is_ear(i))
+        {
+            triangles.push_back({polygon[prev[i]], polygon[i], polygon[next[i]]});
+            next[prev[i]] = next[i];
+            prev[next[i]] = prev[i];
+            remaining--;
+            // The corner before the ear changed, so it is tried next
+            i = prev[i];
+            numTries = 0;
+        }
+        else
+        {
+            i = next[i];
+            // Only polygons that are not simple have no ear
+            if (++numTries > remaining) return;
+        }
+    }
+    if (orientation(corner(prev[i]), corner(i), corner(next[i])) < 0)
+        triangles.push_back({polygon[prev[i]], polygon[i], polygon[next[i]]});
+}
+
+/* Construction */
+
+void triangulated_subdivision::init(plane &pln)
+{
+    std::vector <point> points;
+    std::unordered_map <vertex*, int> vertex_index;
+    for (edge* e: pln.traverse(primalGraph, traverseNodes))
+    {
+        vertex_index[&e -> origin()] = points.size();
+        points.push_back(e -> originPosition());
+    }
+
+    std::vector <std::vector <int>> faces;
+    triangle_faces.clear();
+    subdivision_edges.clear();
+    for (edge* face: pln.traverse(dualGraph, traverseNodes))
+    {
+        if (face -> origin().getLabel() == 0) continue;
+        std::vector <int> polygon;
+        for (edge &face_edge: *face -> rot())
+        {
+            polygon.push_back(vertex_index[&face_edge.origin()]);
+            subdivision_edges[edgeKey(vertex_index[&face_edge.origin()], vertex_index[&face_edge.destination()])] = &face_edge;
+        }
+        if (polygon.size() == 3)
+            faces.push_back(polygon);
+        else
+            clipEars(points, polygon, faces);
+        triangle_faces.resize(faces.size(), face -> rot());
+    }
+
+    triangles = std::make_unique<hidden_plane>();
+    triangles -> init(points, faces);
+    locator -> init(*triangles);
+
+    std::cout << "Triangulated Subdivision Dimensions -> Num Edges: " << subdivision_edges.size() << " Num Triangles: " << getNumTriangles() << std::endl;
+}
+
+/* Point Location */
+
+// Returns an edge of the subdivision on the face that the triangle of e was clipped from
+edge* triangulated_subdivision::originalFace(edge* e)
+{
+    return triangle_faces[e -> leftfaceLabel() - 1];
+}
+
+// Returns the edge of the subdivision with the same endpoints and direction as e, or NULL if e is a diagonal added by ear clipping
+edge* triangulated_subdivision::originalEdge(edge* e)
+{
+    auto found = subdivision_edges.find(edgeKey(e -> origin().getLabel(), e -> destination().getLabel()));
+    return found == subdivision_edges.end() ? NULL : found -> second;
+}
+
+// Returns an edge on the face of the subdivision that contains p, NULL if p is outside of the plane
+edge* triangulated_subdivision::locate(point p)
+{
+    edge* e = locator -> locate(p);
+    return e == NULL ? NULL : originalFace(e);
+}
+
+// Points on a diagonal are inside the face it was clipped from, points on a vertex are tagged with the edge of that face leaving the vertex
+location triangulated_subdivision::locate_ex(point p)
+{
+    location found = locator -> locate_ex(p);
+    switch (found.type)
+    {
+        case outsidePlane:
+            return found;
+        case onVertex:
+        {
+            edge* face = originalFace(found.e);
+            for (edge &face_edge: *face)
+            {
+                if (face_edge.originPosition() == p)
+                    return {onVertex, &face_edge};
+            }
+            assert(false);
+            return {onVertex, face};
+        }
+        case onEdge:
+        {
+            edge* e = originalEdge(found.e);
+            if (e != NULL)
+                return {onEdge, e};
+            return {inFace, originalFace(found.e)};
+        }
+        default:
+            return {inFace, originalFace(found.e)};
+    }
+}
+
+void triangulated_subdivision::locate_batch(const point* points, size_t numPoints, edge** located)
+{
+    locator -> locate_batch(points, numPoints, located);
+    for (size_t i = 0; i < numPoints; i++)
+    {
+        if (located[i] != NULL)
+            located[i] = originalFace(located[i]);
+    }
+}
+
+int triangulated_subdivision::getNumTriangles()
+{
+    return triangle_faces.size();
+}
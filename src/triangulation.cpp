@@ -5,12 +5,19 @@
 #include "point_location/walking/starting_edge_selector.h"
 #include "point_location/walking/walking_point_location.h"
 #include "uniform_point_rng.h"
+#include "clustered_point_rng.h"
 #include "parsing.h"
+#include "geo_primitives/hilbert_curve.h"
+#include "data_structures/quadtree.h"
 #include <cassert>
 #include <cmath>
 #include <algorithm>
 #include <memory>
 #include <chrono>
+#include <queue>
+#include <unordered_set>
+#include <unordered_map>
+#include <thread>
 
 edge* triangulation::init_bounding_box(const box &LTRB)
 {
@@ -22,7 +29,8 @@ edge* triangulation::init_bounding_box(const box &LTRB)
 // Checks if e violates the delaunay condition upon the insertion of point p
 // If it does, rotates the edge within its quadtrilateral to fix the condition
 // Afterwards checks neighboring edges to see if they now violate the delaunay condition
-void triangulation::fixDelaunayCondition(point p, edge* e)
+// The locator sees a rotated edge as removed and added again, since its endpoints change
+void triangulation::fixDelaunayCondition(point p, edge* e, online_point_location &locator)
 {
     // If e is a boundary edge, it cannot be flipped since it does not have an enclosing quadrilateral
     if (e -> leftfaceLabel() == 0 or e -> rightfaceLabel() == 0) return;
@@ -35,44 +43,39 @@ void triangulation::fixDelaunayCondition(point p, edge* e)
     // If delaunay condition is violated, swap the offending edge
     if (inCircle(c, a, b, p) > 0)
     {
+        locator.removeEdge(e);
         edge* fixed_edge = rotateInEnclosing(e);
+        locator.addEdge(fixed_edge);
         numDelaunayFlips++;
         // All flipped edges will be incident to the inserted point p
         assert(fixed_edge -> originPosition() == p or fixed_edge -> destinationPosition() == p);
         // Need to check if neighbors of the rotated edge need to be fixed
-        fixDelaunayCondition(p, fixed_edge -> fprev());
-        fixDelaunayCondition(p, fixed_edge -> twin() -> fnext());
+        fixDelaunayCondition(p, fixed_edge -> fprev(), locator);
+        fixDelaunayCondition(p, fixed_edge -> twin() -> fnext(), locator);
     }
 }
 
 // Adds point to a triangulation and maintains delaunay property as needed
 void triangulation::addPoint(point p, int index, online_point_location &locator, triangulationType type)
 {
-    edge* located_edge = locator.locate(p);
-    for (edge &face_edge: *located_edge)
-    {
-        point curr_origin = face_edge.originPosition();
-        point curr_destination = face_edge.destinationPosition();
-        if (orientation(curr_origin, p, curr_destination) == 0)
-        {
-            located_edge = &face_edge;
-            break;
-        }
-    }
-    point origin = located_edge -> originPosition();
-    point destination = located_edge -> destinationPosition();
+    // Edits of the previous point are applied before the locator is queried again
+    locator.applyPendingUpdates();
+    location located = locator.locate_ex(p);
+    assert(located.type != outsidePlane);
+    edge* located_edge = located.e;
 
-    // If p is already an endpoint of an edge, no need to add it again
-    if (p == origin or p == destination) return;
+    // If p is already a vertex, no need to add it again
+    if (located.type == onVertex) return;
     // If p is on edge e, delete e and connect p to its surrounding quadrilateral instead of surrounding triangle
-    else if(orientation(origin, p, destination) == 0)
+    else if (located.type == onEdge)
     {
         edge* old_edge = located_edge;
         // Need to set e to oprev since if p were strictly inside face, the new edges would form cw turns w.r.t. the triangle's edges
         // Setting e to e -> oprev() ensures that the new edge will form a cw turn with the newly set e, maintaining the invariant
         located_edge = located_edge -> oprev();
-        deleteEdge(old_edge);
+        // The locator is notified first so that it can still read the endpoints of the edge
         locator.removeEdge(old_edge);
+        deleteEdge(old_edge);
     }
 
     // Get all edges immediately enclosing point p
@@ -99,31 +102,27 @@ void triangulation::addPoint(point p, int index, online_point_location &locator,
         // Need to flip the enclosing edges if they violate the delaunay condition
         for (auto& enclosing_edge: enclosing_edges)
         {
-            fixDelaunayCondition(p, enclosing_edge);
+            fixDelaunayCondition(p, enclosing_edge, locator);
         }
     }
 }
 
 void triangulation::init_triangulation(std::vector <point> &points, triangulationType type, const box &LTRB)
 {
-    int numPoints = points.size();
-
     std::vector <lawsonWalkOptions> walkOptions;
-    int fastWalk = 0;
     // Stochastic walk is unnecessary for delaunay triangulations, but needed to prevent loops in non-delaunay triangulations
+    // Walks start from an edge near the inserted point and only cross a few faces, which is too short for a fast walk to pay off
     switch (type)
     {
         case delaunayTriangulation:
-            walkOptions = {fastRememberingWalk};
-            fastWalk = std::pow(numPoints, 1.0 / 4.0);
+            walkOptions = {rememberingWalk};
             break;
         case arbitraryTriangulation:
-            walkOptions = {stochasticWalk, fastRememberingWalk};
-            fastWalk = std::pow(numPoints, 1.0 / 4.0);
+            walkOptions = {stochasticWalk, rememberingWalk};
             break;
     }
-    std::unique_ptr <walking_scheme> locator_ptr = std::make_unique<lawson_oriented_walk>(lawson_oriented_walk(walkOptions, fastWalk));
-    std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(selectSample, std::pow(numPoints, 1.0 / 3.0)));
+    std::unique_ptr <walking_scheme> locator_ptr = std::make_unique<lawson_oriented_walk>(lawson_oriented_walk(walkOptions));
+    std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(selectGrid));
     walking_point_location locator(locator_ptr, selector_ptr);
     init_triangulation(points, locator, type, LTRB);
 }
@@ -158,6 +157,7 @@ void triangulation::init_triangulation(std::vector <point> &points, online_point
         }
         addPoint(points[i], 4 + i, locator, type);
     }
+    locator.applyPendingUpdates();
     // Label each left face of the triangulation
     int faceNumber = 1;
     for (edge* e: this -> traverse(dualGraph, traverseNodes))
@@ -185,6 +185,396 @@ void triangulation::generateRandomTriangulation(int numPoints, online_point_loca
     init_triangulation(points, locator, type, LTRB);
 }
 
+void triangulation::generateClusteredTriangulation(int numPoints, int numClusters, triangulationType type, const box &LTRB)
+{
+    clustered_point_rng pointRng(LTRB, numClusters);
+    std::vector <point> points = pointRng.getRandom(numPoints);
+    init_triangulation(points, type, LTRB);
+}
+
+/* Nearest Neighbors */
+
+// Corners of the bounding box get the labels 0 to 3, inserted points start at 4
+static bool isBoxCorner(edge* e)
+{
+    return e -> origin().getLabel() < 4;
+}
+
+static T squaredDistance(point a, point b)
+{
+    return dot(a - b, a - b);
+}
+
+// Moves from the origin of e to its closest neighbor while that neighbor is closer to p, and returns an edge whose origin is the last vertex
+// In a delaunay triangulation, a vertex without a neighbor closer to p is the vertex closest to p
+edge* triangulation::descendToNearest(edge* e, point p)
+{
+    T best = squaredDistance(e -> originPosition(), p);
+    while (true)
+    {
+        edge* next = NULL;
+        edge* ring = e;
+        do
+        {
+            T distance = squaredDistance(ring -> destinationPosition(), p);
+            if (distance < best)
+            {
+                best = distance;
+                next = ring -> twin();
+            }
+            ring = ring -> onext();
+        } while (ring != e);
+        if (next == NULL) return e;
+        e = next;
+    }
+}
+
+// Visits the vertices from the origin of nearest (the vertex closest to p) outwards in order of distance to p, and returns the first k that are not box corners
+// The j + 1-th closest vertex is a delaunay neighbor of one of the j closest, so the next closest vertex is always on the frontier
+// The frontier is bounded: a candidate farther than the number of vertices still needed (plus the 4 box corners) can never be returned
+std::vector <vertex*> triangulation::expandNearest(edge* nearest, point p, int k)
+{
+    using candidate = std::pair <T, edge*>;
+    std::vector <vertex*> found;
+    // Sorted from farthest to closest, so that the closest candidate is at the back
+    std::vector <candidate> frontier = {{squaredDistance(nearest -> originPosition(), p), nearest}};
+    // Only a few vertices per result are seen, which is faster to scan than to hash for small k
+    std::vector <vertex*> seen = {nearest -> getOrigin()};
+    std::unordered_set <vertex*> seen_set;
+    const int MAX_SCANNED = 64;
+    auto is_new = [&](vertex* v)
+    {
+        if (seen.size() < MAX_SCANNED)
+        {
+            if (std::find(seen.begin(), seen.end(), v) != seen.end()) return false;
+            seen.push_back(v);
+            if (seen.size() == MAX_SCANNED)
+                seen_set.insert(seen.begin(), seen.end());
+            return true;
+        }
+        return seen_set.insert(v).second;
+    };
+
+    while (found.size() < k and !frontier.empty())
+    {
+        edge* e = frontier.back().second;
+        frontier.pop_back();
+        if (!isBoxCorner(e))
+            found.push_back(e -> getOrigin());
+        size_t bound = k - found.size() + 4;
+        edge* ring = e;
+        do
+        {
+            if (is_new(ring -> twin() -> getOrigin()))
+            {
+                candidate c = {squaredDistance(ring -> destinationPosition(), p), ring -> twin()};
+                frontier.insert(std::upper_bound(frontier.begin(), frontier.end(), c, std::greater <candidate>()), c);
+                if (frontier.size() > bound)
+                    frontier.erase(frontier.begin());
+            }
+            ring = ring -> onext();
+        } while (ring != e);
+    }
+    return found;
+}
+
+// Returns an edge whose origin is the vertex closest to p, starting from the closest vertex of the face given by a locator
+// Points outside of the plane start from any vertex, the descent is correct from every vertex but longer
+edge* triangulation::nearestEdge(edge* located, point p)
+{
+    if (located == NULL)
+        return descendToNearest(incidentEdge, p);
+    edge* start = located;
+    for (edge &face_edge: *located)
+    {
+        if (squaredDistance(face_edge.originPosition(), p) < squaredDistance(start -> originPosition(), p))
+            start = &face_edge;
+    }
+    return descendToNearest(start, p);
+}
+
+// Returns the closest inserted point given the closest vertex, which is only different if that vertex is a box corner
+vertex* triangulation::nearestPoint(edge* nearest, point p)
+{
+    if (!isBoxCorner(nearest))
+        return nearest -> getOrigin();
+    std::vector <vertex*> found = expandNearest(nearest, p, 1);
+    return found.empty() ? NULL : found[0];
+}
+
+vertex* triangulation::nearestVertex(point p, point_location &locator)
+{
+    return nearestPoint(nearestEdge(locator.locate(p), p), p);
+}
+
+// Returns the k closest vertices to p, from closest to farthest
+std::vector <vertex*> triangulation::kNearest(point p, int k, point_location &locator)
+{
+    assert(k >= 0);
+    return expandNearest(nearestEdge(locator.locate(p), p), p, k);
+}
+
+// Points are handled in Hilbert order (see hilbertOrder), so that consecutive walks and searches touch nearby parts of the mesh
+// The located faces are found with a single batch, so locators with fast batches also speed up the queries
+std::vector <size_t> triangulation::locateInHilbertOrder(const point* points, size_t numPoints, std::vector <edge*> &located, point_location &locator)
+{
+    std::vector <size_t> order = hilbertOrder(points, numPoints);
+    std::vector <point> sorted(numPoints);
+    for (size_t k = 0; k < numPoints; k++)
+        sorted[k] = points[order[k]];
+    located.resize(numPoints);
+    locator.locate_batch(sorted.data(), numPoints, located.data());
+    return order;
+}
+
+void triangulation::nearestVertex_batch(const point* points, size_t numPoints, vertex** nearest, point_location &locator)
+{
+    std::vector <edge*> located;
+    std::vector <size_t> order = locateInHilbertOrder(points, numPoints, located, locator);
+    for (size_t k = 0; k < numPoints; k++)
+    {
+        size_t i = order[k];
+        nearest[i] = nearestPoint(nearestEdge(located[k], points[i]), points[i]);
+    }
+}
+
+void triangulation::kNearest_batch(const point* points, size_t numPoints, int k, std::vector <vertex*>* nearest, point_location &locator)
+{
+    assert(k >= 0);
+    std::vector <edge*> located;
+    std::vector <size_t> order = locateInHilbertOrder(points, numPoints, located, locator);
+    for (size_t j = 0; j < numPoints; j++)
+    {
+        size_t i = order[j];
+        nearest[i] = expandNearest(nearestEdge(located[j], points[i]), points[i], k);
+    }
+}
+
+/* Range Queries */
+
+// Appends every bounded face that overlaps clip and can be reached from the left face of start through faces overlapping clip
+// Faces that overlap skip (if given) are visited but not appended, so that neighboring strips of a box do not report a face twice
+// The faces overlapping a convex box are connected through their edges, so the fill only visits them and their neighbors
+void triangulation::floodFillBox(edge* start, const box &clip, const box* skip, std::vector <edge*> &found)
+{
+    std::unordered_set <vertex*> visited = {&start -> leftface()};
+    std::vector <edge*> stack = {start};
+    while (!stack.empty())
+    {
+        edge* face = stack.back();
+        stack.pop_back();
+        if (skip == NULL or !boxOverlapsFace(*skip, face -> invrot(), faceBoundingBox(face -> invrot())))
+            found.push_back(face);
+        for (edge &face_edge: *face)
+        {
+            edge* neighbor = face_edge.twin();
+            if (neighbor -> leftfaceLabel() == 0 or !visited.insert(&neighbor -> leftface()).second) continue;
+            if (boxOverlapsFace(clip, neighbor -> invrot(), faceBoundingBox(neighbor -> invrot())))
+                stack.push_back(neighbor);
+        }
+    }
+}
+
+// Shrinks the box to the bounds of the triangulation, returns false if nothing is left
+bool triangulation::clipToBounds(box &query)
+{
+    T left, top, right, bottom, plane_left, plane_top, plane_right, plane_bottom;
+    std::tie(left, top, right, bottom) = query;
+    std::tie(plane_left, plane_top, plane_right, plane_bottom) = bounds;
+    query = box{std::max(left, plane_left), std::min(top, plane_top), std::min(right, plane_right), std::max(bottom, plane_bottom)};
+    return std::get<0>(query) <= std::get<2>(query) and std::get<3>(query) <= std::get<1>(query);
+}
+
+std::vector <edge*> triangulation::faces_in_box(T left, T top, T right, T bottom, point_location &locator)
+{
+    std::vector <edge*> found;
+    box query{left, top, right, bottom};
+    if (!clipToBounds(query)) return found;
+    edge* start = locator.locate(point(std::get<0>(query), std::get<3>(query)));
+    assert(start != NULL);
+    floodFillBox(start, query, NULL, found);
+    return found;
+}
+
+// Every strip is filled by its own thread, a face is reported by the leftmost strip it overlaps
+std::vector <edge*> triangulation::faces_in_box_parallel(T left, T top, T right, T bottom, point_location &locator, int numThreads)
+{
+    if (numThreads <= 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    box query{left, top, right, bottom};
+    if (!clipToBounds(query)) return {};
+    std::tie(left, top, right, bottom) = query;
+
+    // Strip boundaries are computed once, so neighboring strips share them exactly
+    std::vector <T> cuts(numThreads + 1);
+    for (int t = 0; t <= numThreads; t++)
+        cuts[t] = t == numThreads ? right : left + (right - left) * t / numThreads;
+    std::vector <point> corners;
+    for (int t = 0; t < numThreads; t++)
+        corners.push_back(point(cuts[t], bottom));
+    // Locators are not shared between threads, so the corners are located up front
+    std::vector <edge*> starts(numThreads);
+    locator.locate_batch(corners.data(), numThreads, starts.data());
+
+    std::vector <std::vector <edge*>> found(numThreads);
+    auto fill_strip = [&](int t)
+    {
+        assert(starts[t] != NULL);
+        box strip{cuts[t], top, cuts[t + 1], bottom}, previous{cuts[t > 0 ? t - 1 : 0], top, cuts[t], bottom};
+        floodFillBox(starts[t], strip, t > 0 ? &previous : NULL, found[t]);
+    };
+    std::vector <std::thread> workers;
+    for (int t = 1; t < numThreads; t++)
+        workers.emplace_back(fill_strip, t);
+    fill_strip(0);
+    for (std::thread &worker: workers)
+        worker.join();
+
+    for (int t = 1; t < numThreads; t++)
+        found[0].insert(found[0].end(), found[t].begin(), found[t].end());
+    return found[0];
+}
+
+/* Straight Walks */
+
+// Walks along the segment from a to b starting from face (an edge on the face containing a) and appends the entered faces to path
+// Returns an edge on the face containing b, or NULL if the segment leaves the plane
+// A face is left where the segment crosses an edge that has b strictly to its right, there is only one such point since faces are convex
+// If that point is a vertex, the walk pivots around the vertex to the face whose corner contains the direction to b
+edge* triangulation::walkSegmentFrom(edge* face, point a, point b, std::vector <edge*> &path)
+{
+    path.push_back(face);
+    edge* entry = NULL;
+    while (true)
+    {
+        edge *exit = NULL, *pivot = NULL;
+        for (edge &face_edge: *face)
+        {
+            // The entry edge has b strictly to its left
+            if (&face_edge == entry) continue;
+            point u = face_edge.originPosition(), v = face_edge.destinationPosition();
+            if (orientation(u, v, b) <= 0) continue;
+            T side_u = orientation(a, b, u), side_v = orientation(a, b, v);
+            // The segment crosses the inside of the edge
+            if (side_u > 0 and side_v < 0)
+            {
+                exit = &face_edge;
+                break;
+            }
+            // The segment passes through an endpoint of the edge
+            if (side_u == 0 or side_v == 0)
+            {
+                pivot = side_u == 0 ? &face_edge : face_edge.fnext();
+                break;
+            }
+        }
+
+        if (exit != NULL)
+        {
+            if (exit -> rightfaceLabel() == 0) return NULL;
+            face = entry = exit -> twin();
+        }
+        else if (pivot != NULL)
+        {
+            // The left face of an edge is the corner between the edge and the next edge counterclockwise around their origin
+            // The corner containing the direction to b has b to the left of its first edge and to the right of its second edge (or on them)
+            // A segment along an edge may use either face of the edge, but only the one inside the plane if the edge is on its boundary
+            point w = pivot -> originPosition();
+            edge* corner = NULL;
+            edge* ring = pivot;
+            do
+            {
+                if (ring -> leftfaceLabel() != 0 and orientation(w, ring -> destinationPosition(), b) <= 0 and orientation(w, ring -> onext() -> destinationPosition(), b) >= 0)
+                {
+                    corner = ring;
+                    break;
+                }
+                ring = ring -> onext();
+            } while (ring != pivot);
+            // Only the outside face is left, whose corner is not convex
+            if (corner == NULL) return NULL;
+            face = corner;
+            entry = NULL;
+        }
+        // If no edge has b to its right, then b is inside the face
+        else
+            return face;
+        path.push_back(face);
+    }
+}
+
+std::vector <edge*> triangulation::walkSegment(point a, point b, point_location &locator)
+{
+    std::vector <edge*> path;
+    edge* start = locator.locate(a);
+    if (start != NULL)
+        walkSegmentFrom(start, a, b, path);
+    return path;
+}
+
+// Only the first point is located, unless a segment leaves the plane
+void triangulation::walkPolyline(const point* points, size_t numPoints, std::vector <edge*>* paths, point_location &locator)
+{
+    if (numPoints == 0) return;
+    edge* face = locator.locate(points[0]);
+    for (size_t i = 0; i + 1 < numPoints; i++)
+    {
+        paths[i].clear();
+        if (face == NULL)
+            face = locator.locate(points[i]);
+        if (face != NULL)
+            face = walkSegmentFrom(face, points[i], points[i + 1], paths[i]);
+    }
+}
+
+/* Frozen Snapshots */
+
+// Vertices and triangles are numbered along the Hilbert curve, every bounded face must be a triangle
+frozen_triangulation triangulation::freeze()
+{
+    std::vector <edge*> vertex_edges = traverse(primalGraph, traverseNodes);
+    std::vector <point> positions;
+    for (edge* e: vertex_edges)
+        positions.push_back(e -> originPosition());
+    std::unordered_map <vertex*, int32_t> vertex_index;
+    std::vector <T> xs, ys;
+    for (size_t i: hilbertOrder(positions.data(), positions.size()))
+    {
+        vertex_index[&vertex_edges[i] -> origin()] = xs.size();
+        xs.push_back(positions[i].x);
+        ys.push_back(positions[i].y);
+    }
+
+    std::vector <edge*> triangle_edges;
+    std::vector <point> centroids;
+    for (edge* face: traverse(dualGraph, traverseNodes))
+    {
+        if (face -> origin().getLabel() == 0) continue;
+        edge* e = face -> rot();
+        // Make sure that the face is a triangle
+        assert(e -> fnext() -> fnext() -> fnext() == e);
+        triangle_edges.push_back(e);
+        centroids.push_back((e -> originPosition() + e -> fnext() -> originPosition() + e -> fnext() -> fnext() -> originPosition()) / 3);
+    }
+    std::vector <size_t> order = hilbertOrder(centroids.data(), centroids.size());
+    std::unordered_map <vertex*, int32_t> triangle_index;
+    for (size_t t = 0; t < order.size(); t++)
+        triangle_index[&triangle_edges[order[t]] -> leftface()] = t;
+
+    std::vector <int32_t> vertices, neighbors, labels;
+    for (size_t i: order)
+    {
+        edge* e = triangle_edges[i];
+        labels.push_back(e -> leftfaceLabel());
+        for (int k = 0; k < 3; k++, e = e -> fnext())
+        {
+            vertices.push_back(vertex_index[&e -> origin()]);
+            neighbors.push_back(e -> rightfaceLabel() == 0 ? -1 : triangle_index[&e -> rightface()]);
+        }
+    }
+    return frozen_triangulation(xs, ys, vertices, neighbors, labels);
+}
+
 void triangulation::read_PT_file(std::istream &is, triangulationType type)
 {
     std::vector <point> points = parse_PT_file(is);
@@ -0,0 +1,252 @@
+#include "point_location/non_walking/uniform_grid.h"
+#include "planar_structure/plane.h"
+#include "data_structures/quadtree.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <thread>
+#include <assert.h>
+
+uniform_grid::uniform_grid(double cellsPerFace, gridCellContents c, int threads)
+{
+    assert(cellsPerFace > 0);
+    CELLS_PER_FACE = cellsPerFace;
+    contents = c;
+    numThreads = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    // Faces of arbitrary triangulations can make a plain oriented walk loop forever
+    walker.setParameters({stochasticWalk, rememberingWalk});
+}
+
+/* Grid Helpers */
+
+// Returns the column whose closed x-range (as computed by cellBounds) contains x, clamped to the grid
+int uniform_grid::columnOf(T x) const
+{
+    if (!(cell_width > 0)) return 0;
+    int column = std::max(0, std::min(numColumns - 1, (int) std::floor((x - left) / cell_width)));
+    // Rounding can put x one column away from the column whose bounds contain it
+    T column_left, column_right;
+    std::tie(column_left, std::ignore, column_right, std::ignore) = cellBounds(column, 0);
+    if (x < column_left and column > 0) column--;
+    else if (x > column_right and column + 1 < numColumns) column++;
+    return column;
+}
+
+// Returns the row whose closed y-range (as computed by cellBounds) contains y, clamped to the grid
+int uniform_grid::rowOf(T y) const
+{
+    if (!(cell_height > 0)) return 0;
+    int row = std::max(0, std::min(numRows - 1, (int) std::floor((y - bottom) / cell_height)));
+    T row_top, row_bottom;
+    std::tie(std::ignore, row_top, std::ignore, row_bottom) = cellBounds(0, row);
+    if (y < row_bottom and row > 0) row--;
+    else if (y > row_top and row + 1 < numRows) row++;
+    return row;
+}
+
+// Returns (left, top, right, bottom) of the given cell, where row 0 is the bottom row
+// Every boundary is computed from the index of the cell to its right or top, so neighboring cells share it exactly
+std::tuple <T, T, T, T> uniform_grid::cellBounds(int column, int row) const
+{
+    T cell_left = left + column * cell_width, cell_bottom = bottom + row * cell_height;
+    T cell_right = column + 1 == numColumns ? right : left + (column + 1) * cell_width;
+    T cell_top = row + 1 == numRows ? top : bottom + (row + 1) * cell_height;
+    return std::make_tuple(cell_left, cell_top, cell_right, cell_bottom);
+}
+
+// Gives every cell a face to walk from, which is a face stored in the nearest non-empty cell (by grid distance)
+void uniform_grid::computeStartFaces()
+{
+    start_faces.assign(numColumns * numRows, -1);
+    std::queue <int> cell_queue;
+    for (int cell = 0; cell < numColumns * numRows; cell++)
+    {
+        if (cell_offsets[cell] < cell_offsets[cell + 1])
+        {
+            start_faces[cell] = face_ids[cell_offsets[cell]];
+            cell_queue.push(cell);
+        }
+    }
+    // Multi-source breadth first search from the non-empty cells
+    while (!cell_queue.empty())
+    {
+        int cell = cell_queue.front();
+        cell_queue.pop();
+        int column = cell % numColumns, row = cell / numColumns;
+        int neighbors[4][2] = {{column - 1, row}, {column + 1, row}, {column, row - 1}, {column, row + 1}};
+        for (auto &neighbor: neighbors)
+        {
+            if (neighbor[0] < 0 or neighbor[0] >= numColumns or neighbor[1] < 0 or neighbor[1] >= numRows) continue;
+            int next = neighbor[1] * numColumns + neighbor[0];
+            if (start_faces[next] != -1) continue;
+            start_faces[next] = start_faces[cell];
+            cell_queue.push(next);
+        }
+    }
+}
+
+/* Construction */
+
+// Assumes that every bounded face of the plane is a triangle
+// Faces are split into one chunk per thread, every thread finds the cells of its faces and the results are merged into the CSR arrays
+void uniform_grid::init(plane &pln)
+{
+    std::vector <edge*> dual_faces;
+    for (edge* face: pln.traverse(dualGraph, traverseNodes))
+    {
+        if (face -> origin().getLabel() == 0) continue;
+        dual_faces.push_back(face);
+    }
+    faces.clear();
+    for (edge* face: dual_faces)
+        faces.push_back(face -> rot());
+
+    // Pick the number of columns so that cells are close to square
+    std::tie(left, top, right, bottom) = pln.bounds;
+    T width = right - left, height = top - bottom;
+    long long numCells = std::max(1LL, std::llround(CELLS_PER_FACE * faces.size()));
+    if (width > 0 and height > 0)
+        numColumns = std::max(1LL, std::min(numCells, std::llround(std::sqrt(numCells * width / height))));
+    else
+        numColumns = width > 0 ? numCells : 1;
+    numRows = (numCells + numColumns - 1) / numColumns;
+    numCells = (long long) numColumns * numRows;
+    cell_width = width / numColumns;
+    cell_height = height / numRows;
+
+    // Pairs of (cell, face) found by each thread
+    std::vector <std::vector <std::pair <int, int>>> found(numThreads);
+    int chunk = (dual_faces.size() + numThreads - 1) / numThreads;
+    auto find_cells = [&](int t)
+    {
+        for (int i = t * chunk; i < std::min((t + 1) * chunk, (int) dual_faces.size()); i++)
+        {
+            if (contents == centroidFaces)
+            {
+                point centroid(0, 0);
+                for (auto it = faces[i] -> begin(incidentOnFace); it != faces[i] -> end(incidentOnFace); ++it)
+                    centroid = centroid + it -> originPosition();
+                centroid = centroid / 3;
+                found[t].push_back({rowOf(centroid.y) * numColumns + columnOf(centroid.x), i});
+                continue;
+            }
+
+            std::tuple <T, T, T, T> face_box = faceBoundingBox(dual_faces[i]);
+            T face_left, face_top, face_right, face_bottom;
+            std::tie(face_left, face_top, face_right, face_bottom) = face_box;
+            // Cells next to the bounding box are also tested, in case the face only touches their boundary
+            int first_column = std::max(0, columnOf(face_left) - 1), last_column = std::min(numColumns - 1, columnOf(face_right) + 1);
+            int first_row = std::max(0, rowOf(face_bottom) - 1), last_row = std::min(numRows - 1, rowOf(face_top) + 1);
+            for (int row = first_row; row <= last_row; row++)
+            {
+                for (int column = first_column; column <= last_column; column++)
+                {
+                    if (boxOverlapsFace(cellBounds(column, row), dual_faces[i], face_box))
+                        found[t].push_back({row * numColumns + column, i});
+                }
+            }
+        }
+    };
+    std::vector <std::thread> workers;
+    for (int t = 1; t < numThreads; t++)
+        workers.emplace_back(find_cells, t);
+    find_cells(0);
+    for (std::thread &worker: workers)
+        worker.join();
+
+    // Each cell is padded to whole blocks so that it starts at a block boundary
+    std::vector <int> counts(numCells, 0);
+    for (auto &pairs: found)
+        for (auto &cell_face: pairs)
+            counts[cell_face.first]++;
+    cell_offsets.assign(numCells + 1, 0);
+    for (int cell = 0; cell < numCells; cell++)
+        cell_offsets[cell + 1] = cell_offsets[cell] + (counts[cell] + triangle_block::WIDTH - 1) / triangle_block::WIDTH * triangle_block::WIDTH;
+    face_ids.assign(cell_offsets.back(), -1);
+    std::vector <int> next_slot(cell_offsets.begin(), cell_offsets.end() - 1);
+    for (auto &pairs: found)
+        for (auto &cell_face: pairs)
+            face_ids[next_slot[cell_face.first]++] = cell_face.second;
+    std::vector <std::vector <std::pair <int, int>>>().swap(found);
+
+    // Cells never share a block, so threads can pack disjoint ranges of cells
+    blocks.assign(cell_offsets.back() / triangle_block::WIDTH, triangle_block());
+    workers.clear();
+    int cell_chunk = (numCells + numThreads - 1) / numThreads;
+    auto pack_cells = [&](int t)
+    {
+        for (int slot = cell_offsets[std::min((long long) t * cell_chunk, numCells)]; slot < cell_offsets[std::min((long long) (t + 1) * cell_chunk, numCells)]; slot++)
+        {
+            if (face_ids[slot] != -1)
+                blocks[slot / triangle_block::WIDTH].set(slot % triangle_block::WIDTH, faces[face_ids[slot]]);
+        }
+    };
+    for (int t = 1; t < numThreads; t++)
+        workers.emplace_back(pack_cells, t);
+    pack_cells(0);
+    for (std::thread &worker: workers)
+        worker.join();
+
+    if (contents == centroidFaces)
+        computeStartFaces();
+    else
+        start_faces.clear();
+
+    auto dimension = getDimensions();
+    std::cout << "Uniform Grid Dimensions -> Num Cells: " << dimension.first << " Num Stored Faces: " << dimension.second << " Memory: " << getMemoryUsage() << " bytes" << std::endl;
+}
+
+/* Point Location */
+
+// Returns pointer to some edge that belongs to the face that contains p
+// Returns NULL if p is outside the plane
+edge* uniform_grid::locate(point p)
+{
+    return locate(p, walker);
+}
+
+// Same as locate, with misses of centroidFaces grids walking with the given walk
+edge* uniform_grid::locate(point p, lawson_oriented_walk &walk)
+{
+    if (numColumns == 0 or p.x < left or p.x > right or p.y < bottom or p.y > top)
+        return NULL;
+
+    int cell = rowOf(p.y) * numColumns + columnOf(p.x);
+    int first_block = cell_offsets[cell] / triangle_block::WIDTH;
+    int numBlocks = cell_offsets[cell + 1] / triangle_block::WIDTH - first_block;
+    int index = findInBlocks(blocks.data() + first_block, numBlocks, p);
+    if (index != -1)
+        return faces[face_ids[cell_offsets[cell] + index]];
+
+    // Only centroidFaces can miss the face containing p, in which case p is close to the faces of the cell
+    if (contents == centroidFaces and start_faces[cell] != -1)
+        return walk.locate(faces[start_faces[cell]], p);
+    return NULL;
+}
+
+std::unique_ptr <query_context> uniform_grid::createQueryContext()
+{
+    auto context = std::make_unique<grid_context>();
+    context -> walker = walker;
+    return context;
+}
+
+void uniform_grid::locate_batch_in_context(const point* points, size_t numPoints, edge** located, query_context* context)
+{
+    lawson_oriented_walk &walk = static_cast<grid_context*>(context) -> walker;
+    for (size_t i = 0; i < numPoints; i++)
+        located[i] = locate(points[i], walk);
+}
+
+// Returns number of cells along with the number of face references stored in them (padding excluded)
+std::pair <int, int> uniform_grid::getDimensions()
+{
+    return {numColumns * numRows, std::count_if(face_ids.begin(), face_ids.end(), [](int id){return id != -1;})};
+}
+
+// Returns the number of bytes used by the CSR arrays with their packed coordinates, the face table and the starting faces
+size_t uniform_grid::getMemoryUsage()
+{
+    return cell_offsets.size() * sizeof(int) + face_ids.size() * sizeof(int) + blocks.size() * sizeof(triangle_block) +
+           faces.size() * sizeof(edge*) + start_faces.size() * sizeof(int);
+}
@@ -1,6 +1,8 @@
 #include "point_location/walking/walking_point_location.h"
 #include "planar_structure/plane.h"
+#include "geo_primitives/hilbert_curve.h"
 #include <memory>
+#include <vector>
 
 walking_point_location::walking_point_location(std::unique_ptr <walking_scheme> &loc, std::unique_ptr <starting_edge_selector> &sel)
 {
@@ -8,6 +10,16 @@ walking_point_location::walking_point_location(std::unique_ptr <walking_scheme>
     selector = std::move(sel);
 }
 
+void walking_point_location::setBatchOrder(batchWalkOrder order)
+{
+    batchOrder = order;
+}
+
+void walking_point_location::setBatchStarts(batchWalkStarts starts)
+{
+    batchStarts = starts;
+}
+
 void walking_point_location::init(plane &pln)
 {
     selector -> setPlane(pln);
@@ -30,3 +42,73 @@ edge* walking_point_location::locate(point p)
     selector -> locatedEdge(located);
     return located;
 }
+
+location walking_point_location::locate_ex(point p)
+{
+    edge* start = selector -> getStartingEdge(p);
+    location located = locator -> locate_ex(start, p);
+    selector -> locatedEdge(located.e);
+    return located;
+}
+
+// With previousAnswerStarts, starts each walk from whichever is closer to its query point, the edge given by startingEdge or the edge found for the previous query
+// Consecutive queries that are close to each other (like points sorted along a curve) then only walk the faces between them
+// With selectorStarts, every walk starts from the edge given by startingEdge and the whole batch is handed to the walking scheme at once
+void walking_point_location::walkBatch(const point* points, size_t numPoints, edge** located, walking_scheme &walker,
+                                       const std::function <edge*(point)> &startingEdge, const std::function <void(edge*)> &locatedEdge)
+{
+    std::vector <size_t> order;
+    if (batchOrder == hilbertSortedOrder)
+        order = hilbertOrder(points, numPoints);
+
+    if (batchStarts == selectorStarts)
+    {
+        std::vector <point> walkPoints(numPoints);
+        std::vector <edge*> starts(numPoints), found(numPoints);
+        for (size_t k = 0; k < numPoints; k++)
+        {
+            walkPoints[k] = points[batchOrder == hilbertSortedOrder ? order[k] : k];
+            starts[k] = startingEdge(walkPoints[k]);
+        }
+        walker.locate_batch(starts.data(), walkPoints.data(), numPoints, found.data());
+        for (size_t k = 0; k < numPoints; k++)
+        {
+            located[batchOrder == hilbertSortedOrder ? order[k] : k] = found[k];
+            locatedEdge(found[k]);
+        }
+        return;
+    }
+
+    edge* previous = NULL;
+    for (size_t k = 0; k < numPoints; k++)
+    {
+        size_t i = batchOrder == hilbertSortedOrder ? order[k] : k;
+        edge* start = startingEdge(points[i]);
+        if (previous != NULL and (previous -> originPosition() - points[i]).magnitudeSquared() < (start -> originPosition() - points[i]).magnitudeSquared())
+            start = previous;
+        located[i] = walker.locate(start, points[i]);
+        locatedEdge(located[i]);
+        if (located[i] != NULL)
+            previous = located[i];
+    }
+}
+
+void walking_point_location::locate_batch(const point* points, size_t numPoints, edge** located)
+{
+    walkBatch(points, numPoints, located, *locator, [&](point p){return selector -> getStartingEdge(p);}, [&](edge* e){selector -> locatedEdge(e);});
+}
+
+std::unique_ptr <query_context> walking_point_location::createQueryContext()
+{
+    auto context = std::make_unique<walking_context>();
+    context -> walker = locator -> clone();
+    context -> generator.seed(std::random_device{}());
+    return context;
+}
+
+// Same as locate_batch, with the walk and its starting edges only modifying the context
+void walking_point_location::locate_batch_in_context(const point* points, size_t numPoints, edge** located, query_context* context)
+{
+    walking_context &walk = *static_cast<walking_context*>(context);
+    walkBatch(points, numPoints, located, *walk.walker, [&](point p){return selector -> getStartingEdge(p, walk.recentEdge, walk.generator);}, [&](edge* e){walk.recentEdge = e;});
+}
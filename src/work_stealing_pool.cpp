@@ -0,0 +1,111 @@
+#include "parallel/work_stealing_pool.h"
+#include <algorithm>
+#include <assert.h>
+
+work_stealing_pool::work_stealing_pool(int numThreads)
+{
+    if (numThreads <= 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int t = 0; t < numThreads; t++)
+        queues.push_back(std::make_unique<task_queue>());
+    for (int t = 1; t < numThreads; t++)
+        workers.emplace_back(&work_stealing_pool::workerLoop, this, t);
+}
+
+work_stealing_pool::~work_stealing_pool()
+{
+    {
+        std::lock_guard <std::mutex> guard(job_lock);
+        stopping = true;
+    }
+    job_ready.notify_all();
+    for (std::thread &worker: workers)
+        worker.join();
+}
+
+int work_stealing_pool::getNumThreads()
+{
+    return queues.size();
+}
+
+// Takes the last task of the own queue, otherwise steals the first task of the next non-empty queue
+// Returns false once every queue is empty
+bool work_stealing_pool::takeTask(int thread, size_t &task)
+{
+    {
+        task_queue &own = *queues[thread];
+        std::lock_guard <std::mutex> guard(own.lock);
+        if (!own.tasks.empty())
+        {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (int i = 1; i < queues.size(); i++)
+    {
+        task_queue &victim = *queues[(thread + i) % queues.size()];
+        std::lock_guard <std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void work_stealing_pool::work(int thread)
+{
+    size_t task;
+    while (takeTask(thread, task))
+        job(thread, task);
+}
+
+// Waits for every new job, works on it and reports back once no task is left to take
+void work_stealing_pool::workerLoop(int thread)
+{
+    size_t seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock <std::mutex> guard(job_lock);
+            job_ready.wait(guard, [&]{return stopping or generation != seen;});
+            if (stopping) return;
+            seen = generation;
+        }
+        work(thread);
+        {
+            std::lock_guard <std::mutex> guard(job_lock);
+            numBusy--;
+        }
+        job_done.notify_one();
+    }
+}
+
+void work_stealing_pool::run(size_t numTasks, const std::function <void(int, size_t)> &task)
+{
+    // Tasks are dealt out in contiguous ranges, so neighboring tasks stay on the same thread unless they are stolen
+    int numThreads = queues.size();
+    for (int t = 0; t < numThreads; t++)
+    {
+        std::lock_guard <std::mutex> guard(queues[t] -> lock);
+        assert(queues[t] -> tasks.empty());
+        // Ranges are pushed in reverse, so that the owner (taking from the back) starts at the beginning of its range
+        for (size_t i = (t + 1) * numTasks / numThreads; i > t * numTasks / numThreads; i--)
+            queues[t] -> tasks.push_back(i - 1);
+    }
+    {
+        std::lock_guard <std::mutex> guard(job_lock);
+        job = task;
+        numBusy = workers.size();
+        generation++;
+    }
+    job_ready.notify_all();
+
+    work(0);
+
+    std::unique_lock <std::mutex> guard(job_lock);
+    job_done.wait(guard, [&]{return numBusy == 0;});
+}
@@ -1,14 +1,27 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <cassert>
 #include <cmath>
+#include <cstring>
 #include <algorithm>
 #include <memory>
+#include <thread>
+#include <random>
 #include "planar_structure/triangulation.h"
 #include "point_location/walking/lawson_oriented_walk.h"
+#include "point_location/walking/lawson_walk.h"
 #include "point_location/walking/walking_point_location.h"
 #include "point_location/non_walking/slab_decomposition.h"
 #include "point_location/non_walking/naive_quadtree.h"
+#include "point_location/non_walking/kirkpatrick_hierarchy.h"
+#include "point_location/non_walking/trapezoidal_map.h"
+#include "point_location/non_walking/persistent_slab_decomposition.h"
+#include "point_location/non_walking/uniform_grid.h"
+#include "point_location/non_walking/triangulated_subdivision.h"
+#include "point_location/non_walking/hilbert_rtree.h"
+#include "parallel/work_stealing_pool.h"
+#include "parallel/parallel_locate.h"
 #include "uniform_point_rng.h"
 #include "testing.h"
 
@@ -28,7 +41,7 @@ bool in_face(point p, edge* e)
     {
         // Assumes that edges in a face are ccw oriented
         // If the point is strictly to the right of an edge, it cannot be inside the face
-        if (orientation(e -> originPosition(), e -> destinationPosition(), p) > 0)
+        if (orientation(face_edge.originPosition(), face_edge.destinationPosition(), p) > 0)
         {
             return false;
         }
@@ -57,6 +70,131 @@ bool fulfills_delaunay(edge *e)
     return res;
 }
 
+/* Helper Functions for benchmarking several locators on the same triangulation */
+
+enum pointDistribution
+{
+    uniformDistribution,
+    clusteredDistribution
+};
+
+using named_locator = std::pair <std::string, point_location*>;
+
+// Returns true if e is the correct answer for locating p in a triangulation of the given bounding box, printing the mistake otherwise
+bool correctly_located(point p, edge* e, int left, int top, int right, int bottom)
+{
+    bool expected_in_box = in_padded_bounding_box(p, left, top, right, bottom);
+    bool found_in_box = (e != nullptr);
+    if (expected_in_box != found_in_box)
+    {
+        std::cout << "Incorrect: " << p << " in plane was supposed to be " << expected_in_box << " but you found " << found_in_box << std::endl;
+        return false;
+    }
+    else if(found_in_box and !in_face(p, e))
+    {
+        std::cout << "Incorrect: " << p << " is not in face: " << std::endl;
+        for (edge &face_edges: *e)
+        {
+            std::cout << face_edges << std::endl;
+        }
+        return false;
+    }
+    return true;
+}
+
+std::string distribution_name(pointDistribution distribution)
+{
+    return distribution == uniformDistribution ? "uniform" : "clustered";
+}
+
+/* Helper Functions for nearest neighbor baselines */
+
+// Static kd-tree over the inserted points of a triangulation, kept only as a baseline for the nearest neighbor queries of the triangulation
+// The tree is implicit: the median of every range splits the range along alternating axes
+class kd_tree
+{
+private:
+    std::vector <std::pair <point, vertex*>> nodes;
+    using candidate = std::pair <T, vertex*>;
+
+    void build(int lo, int hi, bool byY)
+    {
+        if (hi - lo <= 1) return;
+        int mid = (lo + hi) / 2;
+        std::nth_element(nodes.begin() + lo, nodes.begin() + mid, nodes.begin() + hi, [byY](const std::pair <point, vertex*> &a, const std::pair <point, vertex*> &b)
+        {
+            return byY ? a.first.y < b.first.y : a.first.x < b.first.x;
+        });
+        build(lo, mid, !byY);
+        build(mid + 1, hi, !byY);
+    }
+
+    // Keeps the k closest points found so far in a max-heap
+    void search(int lo, int hi, bool byY, point p, int k, std::vector <candidate> &heap)
+    {
+        if (lo >= hi) return;
+        int mid = (lo + hi) / 2;
+        point q = nodes[mid].first;
+        T distance = dot(q - p, q - p);
+        if (heap.size() < k or distance < heap.front().first)
+        {
+            heap.push_back({distance, nodes[mid].second});
+            std::push_heap(heap.begin(), heap.end());
+            if (heap.size() > k)
+            {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.pop_back();
+            }
+        }
+        T difference = byY ? p.y - q.y : p.x - q.x;
+        search(difference < 0 ? lo : mid + 1, difference < 0 ? mid : hi, !byY, p, k, heap);
+        if (heap.size() < k or difference * difference < heap.front().first)
+            search(difference < 0 ? mid + 1 : lo, difference < 0 ? hi : mid, !byY, p, k, heap);
+    }
+public:
+    // Corners of the bounding box (labels 0 to 3) are left out, like in the queries of the triangulation
+    void init(triangulation &tr)
+    {
+        nodes.clear();
+        for (edge* e: tr.traverse(primalGraph, traverseNodes))
+        {
+            if (e -> origin().getLabel() < 4) continue;
+            nodes.push_back({e -> originPosition(), &e -> origin()});
+        }
+        build(0, nodes.size(), false);
+    }
+
+    // Returns the k closest points to p, from closest to farthest
+    std::vector <vertex*> kNearest(point p, int k)
+    {
+        std::vector <candidate> heap;
+        search(0, nodes.size(), false, p, k, heap);
+        std::sort_heap(heap.begin(), heap.end());
+        std::vector <vertex*> found;
+        for (candidate &c: heap)
+            found.push_back(c.second);
+        return found;
+    }
+
+    size_t getMemoryUsage()
+    {
+        return nodes.size() * sizeof(nodes[0]);
+    }
+};
+
+// Returns true if both lists have the same length and the same distances to p at every rank, so ties may be broken differently
+bool same_nearest(point p, const std::vector <vertex*> &found, const std::vector <vertex*> &expected)
+{
+    if (found.size() != expected.size()) return false;
+    for (int i = 0; i < found.size(); i++)
+    {
+        point a = found[i] -> getPosition(), b = expected[i] -> getPosition();
+        if (dot(a - p, a - p) != dot(b - p, b - p))
+            return false;
+    }
+    return true;
+}
+
 /* Tests */
 
 void test_random_point_location_in_random_triangulation(point_location &locator, int numPoints, bool delaunay)
@@ -105,6 +243,23 @@ void test_random_point_location_in_random_triangulation(point_location &locator,
     uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
     std::vector <point> locating = rng.getRandom(numPoints);
 
+    // Time the same queries one at a time and as a single batch, the batch has to find the same faces
+    std::vector <edge*> located(numPoints), batch_located(numPoints);
+    startTimer();
+    for (int i = 0; i < numPoints; i++)
+        located[i] = locator.locate(locating[i]);
+    print_throughput("locate", numPoints, endTimer());
+    startTimer();
+    locator.locate_batch(locating.data(), numPoints, batch_located.data());
+    print_throughput("locate_batch", numPoints, endTimer());
+    int numBatchCorrect = 0;
+    for (int i = 0; i < numPoints; i++)
+    {
+        if (correctly_located(locating[i], batch_located[i], left, top, right, bottom))
+            numBatchCorrect++;
+    }
+    print_percent_correct("test_random_point_location_in_random_triangulation locate_batch", numBatchCorrect, numPoints);
+
     startTimer();
     for (point p: locating)
     {
@@ -135,6 +290,308 @@ void test_random_point_location_in_random_triangulation(point_location &locator,
         print_percent_correct("test_random_point_location_in_random_delaunay_triangulation: ", numCorrect, numPoints);
 }
 
+// Builds one delaunay triangulation from the given distribution and runs the same uniformly random queries through every locator
+// Only the locate calls are timed, correctness is checked afterwards
+void compare_point_locators_in_random_triangulation(const std::vector <named_locator> &locators, int numPoints, pointDistribution distribution)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    std::tuple <T, T, T, T> bounding_box{left, top, right, bottom};
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    int numClusters = 20;
+
+    startTimer();
+    if (distribution == uniformDistribution)
+        tr.generateRandomTriangulation(numPoints, delaunayTriangulation, bounding_box);
+    else
+        tr.generateClusteredTriangulation(numPoints, numClusters, delaunayTriangulation, bounding_box);
+    endTimer();
+    print_time("Generating " + distribution_name(distribution) + " delaunay random triangulation");
+
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> locating = rng.getRandom(numPoints);
+    std::vector <edge*> located(numPoints);
+
+    for (const named_locator &entry: locators)
+    {
+        const std::string &name = entry.first;
+        point_location &locator = *entry.second;
+
+        startTimer();
+        locator.init(tr);
+        endTimer();
+        print_time("constructing " + name + " on " + distribution_name(distribution) + " data");
+
+        startTimer();
+        for (int i = 0; i < numPoints; i++)
+            located[i] = locator.locate(locating[i]);
+        endTimer();
+        print_time("locating with " + name + " on " + distribution_name(distribution) + " data");
+
+        int numCorrect = 0;
+        for (int i = 0; i < numPoints; i++)
+        {
+            if (correctly_located(locating[i], located[i], left, top, right, bottom))
+                numCorrect++;
+        }
+        print_percent_correct("compare_point_locators " + name + " " + distribution_name(distribution), numCorrect, numPoints);
+    }
+}
+
+// Runs the same random queries through slab decompositions that only differ in how their binary searches are laid out
+void benchmark_slab_search_layouts(int numPoints, int numQueries)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> locating = rng.getRandom(numQueries);
+    std::vector <edge*> located(numQueries);
+
+    std::vector <std::pair <std::string, slabSearchLayout>> layouts = {{"sorted layout", sortedLayout}, {"btree layout", btreeLayout}};
+    for (auto &entry: layouts)
+    {
+        // Only one decomposition is alive at a time, since each of them stores O(n^2) segments in the worst case
+        slab_decomposition locator(entry.second);
+        locator.init(tr);
+
+        startTimer();
+        for (int i = 0; i < numQueries; i++)
+            located[i] = locator.locate(locating[i]);
+        double t = endTimer();
+        print_throughput("slab decomposition with " + entry.first, numQueries, t);
+
+        int numCorrect = 0;
+        for (int i = 0; i < numQueries; i++)
+        {
+            if (correctly_located(locating[i], located[i], left, top, right, bottom))
+                numCorrect++;
+        }
+        print_percent_correct("benchmark_slab_search_layouts " + entry.first, numCorrect, numQueries);
+    }
+}
+
+// Builds the quadtree of both backends over the same triangulation with an increasing number of threads
+void benchmark_parallel_quadtree_construction(int numPoints)
+{
+    triangulation tr;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(-10000000, 10000000, 10000000, -10000000));
+
+    int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector <std::pair <std::string, quadtreeBackend>> backends = {{"pointer quadtree", pointerQuadtree}, {"linear quadtree", linearQuadtree}};
+    for (auto &entry: backends)
+    {
+        for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+        {
+            naive_quadtree locator(90, 60, entry.second, numThreads);
+            startTimer();
+            locator.init(tr);
+            endTimer();
+            print_time("constructing " + entry.first + " with " + std::to_string(numThreads) + " threads");
+        }
+    }
+}
+
+// Locates points in a triangulation of points whose coordinates span a tiny range (like coordinates given in degrees)
+// Triangulations truncate their bounding box to integers and pad it by 1, so the plane spans +-1 while every inner vertex and query is within +-1.3 extent
+// The quadtree has to split cells far smaller than 1 unit around the points, so leaves should still be as small as for large coordinate ranges
+void benchmark_quadtree_on_small_extent(int numPoints, T extent)
+{
+    triangulation tr;
+    std::tuple <T, T, T, T> bounding_box{-extent, extent, extent, -extent};
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, bounding_box);
+
+    uniform_point_rng rng(-padding_coeff * extent, padding_coeff * extent, padding_coeff * extent, -padding_coeff * extent);
+    std::vector <point> locating = rng.getRandom(numPoints);
+    std::vector <edge*> located(numPoints);
+
+    std::vector <std::pair <std::string, quadtreeBackend>> backends = {{"pointer quadtree", pointerQuadtree}, {"linear quadtree", linearQuadtree}};
+    for (auto &entry: backends)
+    {
+        naive_quadtree locator(90, 60, entry.second);
+        locator.init(tr);
+
+        startTimer();
+        for (int i = 0; i < numPoints; i++)
+            located[i] = locator.locate(locating[i]);
+        double t = endTimer();
+        print_time("locating with " + entry.first + " on points within " + std::to_string(extent), t);
+        print_throughput(entry.first + " on points within " + std::to_string(extent), numPoints, t);
+
+        // Triangulations pad their bounding box after truncating it to integers
+        int numCorrect = 0;
+        for (int i = 0; i < numPoints; i++)
+        {
+            if (correctly_located(locating[i], located[i], (int) -extent, (int) extent, (int) extent, (int) -extent))
+                numCorrect++;
+        }
+        print_percent_correct("benchmark_quadtree_on_small_extent " + entry.first, numCorrect, numPoints);
+    }
+}
+
+// Compares scanning the packed leaves of a quadtree one triangle at a time against a whole block per instruction, for several leaf sizes
+void benchmark_quadtree_leaf_scan(int numPoints)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> locating = rng.getRandom(numPoints);
+    std::vector <edge*> located(numPoints);
+
+    std::vector <std::pair <std::string, quadtreeBackend>> backends = {{"pointer quadtree", pointerQuadtree}, {"linear quadtree", linearQuadtree}};
+    std::vector <std::pair <std::string, leafScanMode>> scans = {{"scalar scan", scalarScan}, {"simd scan", simdScan}};
+    for (int maxOverlap: {10, 30, 90, 270})
+    {
+        for (auto &backend: backends)
+        {
+            naive_quadtree locator(maxOverlap, 60, backend.second);
+            locator.init(tr);
+            for (auto &scan: scans)
+            {
+                locator.setLeafScan(scan.second);
+                std::string name = backend.first + " with " + scan.first + " and MAX_OVERLAP " + std::to_string(maxOverlap);
+
+                startTimer();
+                for (int i = 0; i < numPoints; i++)
+                    located[i] = locator.locate(locating[i]);
+                endTimer();
+                print_time("locating with " + name);
+
+                int numCorrect = 0;
+                for (int i = 0; i < numPoints; i++)
+                {
+                    if (correctly_located(locating[i], located[i], left, top, right, bottom))
+                        numCorrect++;
+                }
+                print_percent_correct("benchmark_quadtree_leaf_scan " + name, numCorrect, numPoints);
+            }
+        }
+    }
+}
+
+// Shows the memory/time tradeoff of uniform grids of several resolutions against quadtrees on the same queries
+// Memory usage of each locator is printed by its init
+void benchmark_uniform_grid(int numPoints, pointDistribution distribution)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    std::tuple <T, T, T, T> bounding_box{left, top, right, bottom};
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    int numClusters = 20;
+    if (distribution == uniformDistribution)
+        tr.generateRandomTriangulation(numPoints, delaunayTriangulation, bounding_box);
+    else
+        tr.generateClusteredTriangulation(numPoints, numClusters, delaunayTriangulation, bounding_box);
+
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> locating = rng.getRandom(numPoints);
+    std::vector <edge*> located(numPoints);
+
+    std::vector <std::unique_ptr <point_location>> locators;
+    std::vector <std::string> names;
+    for (double cellsPerFace: {0.25, 1.0, 4.0})
+    {
+        locators.push_back(std::make_unique<uniform_grid>(cellsPerFace, overlappingFaces));
+        names.push_back("uniform grid of overlapping faces with " + std::to_string(cellsPerFace) + " cells per face");
+        locators.push_back(std::make_unique<uniform_grid>(cellsPerFace, centroidFaces));
+        names.push_back("uniform grid of centroid faces with " + std::to_string(cellsPerFace) + " cells per face");
+    }
+    for (int maxOverlap: {30, 90})
+    {
+        locators.push_back(std::make_unique<naive_quadtree>(maxOverlap, 60));
+        names.push_back("quadtree with MAX_OVERLAP " + std::to_string(maxOverlap));
+    }
+
+    for (int j = 0; j < locators.size(); j++)
+    {
+        startTimer();
+        locators[j] -> init(tr);
+        endTimer();
+        print_time("constructing " + names[j] + " on " + distribution_name(distribution) + " data");
+
+        startTimer();
+        for (int i = 0; i < numPoints; i++)
+            located[i] = locators[j] -> locate(locating[i]);
+        endTimer();
+        print_time("locating with " + names[j] + " on " + distribution_name(distribution) + " data");
+
+        int numCorrect = 0;
+        for (int i = 0; i < numPoints; i++)
+        {
+            if (correctly_located(locating[i], located[i], left, top, right, bottom))
+                numCorrect++;
+        }
+        print_percent_correct("benchmark_uniform_grid " + names[j] + " " + distribution_name(distribution), numCorrect, numPoints);
+        // Free each locator once it has been measured
+        locators[j].reset();
+    }
+}
+
+// Packed Hilbert R-trees against quadtrees, clustered data has faces of very different sizes
+void benchmark_hilbert_rtree(int numPoints, int numQueries, pointDistribution distribution)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    std::tuple <T, T, T, T> bounding_box{left, top, right, bottom};
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    int numClusters = 20;
+    if (distribution == uniformDistribution)
+        tr.generateRandomTriangulation(numPoints, delaunayTriangulation, bounding_box);
+    else
+        tr.generateClusteredTriangulation(numPoints, numClusters, delaunayTriangulation, bounding_box);
+
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> locating = rng.getRandom(numQueries);
+    // Half of the queries are centroids of random faces, which are mostly the small faces of the clusters
+    std::vector <point> centroids;
+    for (edge* face: tr.traverse(dualGraph, traverseNodes))
+    {
+        if (face -> origin().getLabel() == 0) continue;
+        edge* e = face -> rot();
+        centroids.push_back((e -> originPosition() + e -> fnext() -> originPosition() + e -> fnext() -> fnext() -> originPosition()) / 3);
+    }
+    std::shuffle(centroids.begin(), centroids.end(), std::mt19937(1));
+    for (int i = 0; i < numQueries; i += 2)
+        locating[i] = centroids[i / 2 % centroids.size()];
+    std::vector <edge*> located(numQueries);
+
+    std::vector <named_locator> locators;
+    hilbert_rtree rtree_locator;
+    naive_quadtree quad_locator_30(30, 60), quad_locator_90(90, 60);
+    locators = {{"hilbert R-tree", &rtree_locator},
+                {"quadtree with MAX_OVERLAP 30", &quad_locator_30},
+                {"quadtree with MAX_OVERLAP 90", &quad_locator_90}};
+    for (const named_locator &entry: locators)
+    {
+        const std::string &name = entry.first;
+        point_location &locator = *entry.second;
+
+        startTimer();
+        locator.init(tr);
+        endTimer();
+        print_time("constructing " + name + " on " + distribution_name(distribution) + " data");
+
+        startTimer();
+        for (int i = 0; i < numQueries; i++)
+            located[i] = locator.locate(locating[i]);
+        print_throughput("locating with " + name + " on " + distribution_name(distribution) + " data", numQueries, endTimer());
+
+        int numCorrect = 0;
+        for (int i = 0; i < numQueries; i++)
+        {
+            if (correctly_located(locating[i], located[i], left, top, right, bottom))
+                numCorrect++;
+        }
+        print_percent_correct("benchmark_hilbert_rtree " + name + " " + distribution_name(distribution), numCorrect, numQueries);
+    }
+}
+
 void test_delaunay_condition_for_random_triangulation(int numPoints = 100000)
 {
     int numCorrect = 0, total = 0;
@@ -183,86 +640,1201 @@ void test_saving_delaunay_triangulation(int numPoints)
     print_percent_correct("test_saving_delaunay_triangulation", numCorrect, total);
 }
 
-void test_rng_distribution()
+// Locates vertices, points on the bounding box and random points with locate_ex and checks the tag against a rescan of the located face
+void test_locate_ex(int numPoints)
 {
-    int numPoints = 50000000;
-    startTimer();
-    int left = -99, top = 51, right = 101, bottom = -49;
-
-    uniform_point_rng rng(left, top, right, bottom);
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
 
-    int buckets = 20;
-    int xtenths[buckets];
-    int yfifths[buckets];
-    for (int i = 0; i < buckets; i++)
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> locating = rng.getRandom(numPoints);
+    for (edge* e: tr.traverse(primalGraph, traverseNodes))
+        locating.push_back(e -> originPosition());
+    // Points on the vertical sides of the bounding box lie exactly on its edges
+    T box_left, box_top, box_right, box_bottom;
+    std::tie(box_left, box_top, box_right, box_bottom) = tr.bounds;
+    for (point p: rng.getRandom(1000))
     {
-        xtenths[i] = yfifths[i] = 0;
+        locating.push_back(point(box_left, std::max(box_bottom, std::min(box_top, p.y))));
+        locating.push_back(point(box_right, std::max(box_bottom, std::min(box_top, p.y))));
     }
 
-    for (int i = 0; i < numPoints; i++)
+    std::vector <std::pair <std::string, std::vector <lawsonWalkOptions>>> walks = {{"remembering walk", {rememberingWalk}},
+        {"stochastic walk", {stochasticWalk}}, {"fast remembering walk", {fastRememberingWalk}}};
+    for (auto &entry: walks)
     {
-        point p = rng.getRandom();
-        int xbucket = (int) (p.x - left) / 10;
-        int ybucket = (int) (p.y - bottom) / 5;
-        if(xbucket >= 0 and xbucket < buckets and ybucket >= 0 and ybucket < buckets)
+        unsigned int fastSteps = entry.second[0] == fastRememberingWalk ? std::pow(numPoints, 1.0/4.0) : 0;
+        std::unique_ptr <walking_scheme> locator_ptr = std::make_unique<lawson_oriented_walk>(entry.second, fastSteps);
+        std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(selectGrid));
+        walking_point_location locator(locator_ptr, selector_ptr);
+        locator.init(tr);
+
+        int numCorrect = 0, numTags[4] = {0, 0, 0, 0};
+        for (point p: locating)
         {
-            xtenths[xbucket]++;
-            yfifths[ybucket]++;
+            location located = locator.locate_ex(p);
+            numTags[located.type]++;
+            if (!correctly_located(p, located.e, left, top, right, bottom))
+                continue;
+            if (classifyLocation(located.e, p).type != located.type)
+                continue;
+            if (located.type == onVertex and located.e -> originPosition() != p)
+                continue;
+            if (located.type == onEdge and orientation(located.e -> originPosition(), located.e -> destinationPosition(), p) != 0)
+                continue;
+            numCorrect++;
         }
+        std::cout << "Tags found with " << entry.first << ": " << numTags[inFace] << " in face, " << numTags[onEdge] << " on edge, "
+                  << numTags[onVertex] << " on vertex, " << numTags[outsidePlane] << " outside" << std::endl;
+        print_percent_correct("test_locate_ex " + entry.first, numCorrect, locating.size());
     }
-    int minx, maxx, miny, maxy;
-    for (int i = 0; i < buckets; i++)
+
+    // A U-shaped face, whose vertices (0, 3) and (1, 3) and inner point (0.5, 1) are on the lines of edges they are not on
+    std::istringstream off("OFF\n8 1 0\n0 0\n4 0\n4 3\n3 3\n3 1\n1 1\n1 3\n0 3\n8 0 1 2 3 4 5 6 7\n");
+    plane u_shape;
+    u_shape.read_OFF_file(off);
+    edge* face = NULL;
+    for (edge* dual: u_shape.traverse(dualGraph, traverseNodes))
     {
-        std::cout<<"i : " << i << " Xtenths: " << xtenths[i] << " Yfifths: " << yfifths[i] << std::endl;
-        assert(xtenths[i] > 0 and yfifths[i] > 0);
-        if (i == 0)
+        if (dual -> origin().getLabel() != 0)
+            face = dual -> rot();
+    }
+    std::vector <edge*> face_edges;
+    for (edge &face_edge: *face)
+        face_edges.push_back(&face_edge);
+
+    int numCorrect = 0, numTests = 0;
+    std::vector <point> inside = {point(0.5, 1), point(3.5, 1), point(2, 0.5), point(0.5, 2.5)};
+    // Every start edge is tried, since the tags must not depend on where the scan of the face starts
+    for (edge* start: face_edges)
+    {
+        for (edge* face_edge: face_edges)
         {
-            minx = maxx = xtenths[i];
-            miny = maxy = yfifths[i];
+            point a = face_edge -> originPosition(), b = face_edge -> destinationPosition();
+            location at_vertex = classifyLocation(start, a), at_middle = classifyLocation(start, (a + b) / 2);
+            numCorrect += at_vertex.type == onVertex and at_vertex.e == face_edge;
+            numCorrect += at_middle.type == onEdge and at_middle.e == face_edge;
+            numTests += 2;
         }
-        else
+        for (point p: inside)
         {
-            miny = std::min(miny, yfifths[i]);
-            maxy = std::max(maxy, yfifths[i]);
-            minx = std::min(minx, xtenths[i]);
-            maxx = std::max(maxx, xtenths[i]);
+            numCorrect += classifyLocation(start, p).type == inFace;
+            numTests++;
         }
     }
+    print_percent_correct("test_locate_ex non-convex face", numCorrect, numTests);
 
-    bool allSame = true;
-    uniform_point_rng rng2(left, top, right, bottom);
-    for (int i = 0; i < numPoints; i++)
+    // Walks on a convex face with collinear consecutive edges, where p can be on the lines of three edges at once
+    std::istringstream strip_off("OFF\n6 1 0\n0 0\n1 0\n2 0\n2 1\n1 1\n0 1\n6 0 1 2 3 4 5\n");
+    plane strip;
+    strip.read_OFF_file(strip_off);
+    std::unique_ptr <walking_scheme> walk_ptr = std::make_unique<lawson_oriented_walk>(lawson_oriented_walk({rememberingWalk}));
+    std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(selectGrid));
+    walking_point_location strip_locator(walk_ptr, selector_ptr);
+    strip_locator.init(strip);
+    numCorrect = 0, numTests = 0;
+    for (edge* dual: strip.traverse(dualGraph, traverseNodes))
     {
-        point p = rng.getRandom();
-        point p2 = rng2.getRandom();
-        if (p != p2)
-            allSame = false;
+        if (dual -> origin().getLabel() == 0) continue;
+        for (edge &face_edge: *dual -> rot())
+        {
+            point a = face_edge.originPosition(), b = face_edge.destinationPosition();
+            location at_vertex = strip_locator.locate_ex(a), at_middle = strip_locator.locate_ex((a + b) / 2);
+            numCorrect += at_vertex.type == onVertex and at_vertex.e -> originPosition() == a;
+            numCorrect += at_middle.type == onEdge and at_middle.e == &face_edge;
+            numTests += 2;
+        }
     }
+    numCorrect += strip_locator.locate_ex(point(1, 0.5)).type == inFace;
+    numTests++;
+    print_percent_correct("test_locate_ex walk on face with collinear edges", numCorrect, numTests);
+}
 
-    double threshold = 1.01;
-    double x_rat = (double) maxx / minx;
-    double y_rat = (double) maxy / miny;
-    int passed, total;
-    passed = total = 3;
-    if (x_rat > threshold)
+// Writes a numColumns x numRows grid of quadrilateral faces, each cell being cellSize wide, to an OFF file
+// Interior vertices are jittered by at most a fifth of a cell, which keeps every face convex
+void write_random_quadrilateral_subdivision(int numColumns, int numRows, int cellSize, const std::string &file_name)
+{
+    uniform_point_rng jitter_rng(-cellSize / 5.0, cellSize / 5.0, cellSize / 5.0, -cellSize / 5.0);
+    std::ofstream writer(file_name);
+    writer << "OFF" << '\n';
+    writer << (numColumns + 1) * (numRows + 1) << " " << numColumns * numRows << " " << 0 << '\n';
+    for (int j = 0; j <= numRows; j++)
     {
-        std::cout << "Some X values show up too often compared to others" << std::endl;
-        --passed;
+        for (int i = 0; i <= numColumns; i++)
+        {
+            point p(i * cellSize, j * cellSize);
+            if (i != 0 and i != numColumns and j != 0 and j != numRows)
+                p = p + jitter_rng.getRandom();
+            writer << p.x << " " << p.y << '\n';
+        }
     }
-    if (y_rat > threshold)
+    auto index = [&](int i, int j){return j * (numColumns + 1) + i;};
+    for (int j = 0; j < numRows; j++)
     {
-        std::cout << "Some Y values show up too often compared to others" << std::endl;
-        --passed;
+        for (int i = 0; i < numColumns; i++)
+        {
+            writer << 4 << " " << index(i, j) << " " << index(i + 1, j) << " " << index(i + 1, j + 1) << " " << index(i, j + 1) << '\n';
+        }
     }
-    if (allSame)
-    {
-        std::cout << "Different generators produce same sequence of numbers" << std::endl;
-        --passed;
+    writer.close();
+}
+
+// Writes a numColumns x numRows grid of non-convex faces, each cell being cellSize wide, to an OFF file
+// Vertical sides of the cells are zigzags through numBends points jittered by at most a third of a cell, so faces have 2 * numBends + 5 points
+// Horizontal sides have a point in their middle, which is a straight corner of both faces sharing the side
+void write_random_zigzag_subdivision(int numColumns, int numRows, int numBends, int cellSize, const std::string &file_name)
+{
+    uniform_point_rng jitter_rng(-cellSize / 3.0, 0, cellSize / 3.0, 0);
+    std::vector <point> points;
+    // Corners of the cells, then the middles of the horizontal sides, then the bends of the vertical sides
+    auto corner = [&](int i, int j){return j * (numColumns + 1) + i;};
+    auto middle = [&](int i, int j){return (numColumns + 1) * (numRows + 1) + j * numColumns + i;};
+    auto bend = [&](int i, int j, int k){return (numColumns + 1) * (numRows + 1) + numColumns * (numRows + 1) + (j * (numColumns + 1) + i) * numBends + k;};
+    for (int j = 0; j <= numRows; j++)
+        for (int i = 0; i <= numColumns; i++)
+            points.push_back(point(i * cellSize, j * cellSize));
+    for (int j = 0; j <= numRows; j++)
+        for (int i = 0; i < numColumns; i++)
+            points.push_back(point(i * cellSize + cellSize / 2.0, j * cellSize));
+    for (int j = 0; j < numRows; j++)
+    {
+        for (int i = 0; i <= numColumns; i++)
+        {
+            for (int k = 0; k < numBends; k++)
+            {
+                point p(i * cellSize, j * cellSize + (k + 1) * (T) cellSize / (numBends + 1));
+                // The sides of the plane stay straight
+                if (i != 0 and i != numColumns)
+                    p = p + jitter_rng.getRandom();
+                points.push_back(p);
+            }
+        }
+    }
+
+    std::ofstream writer(file_name);
+    writer << "OFF" << '\n';
+    writer << points.size() << " " << numColumns * numRows << " " << 0 << '\n';
+    for (point p: points)
+        writer << p.x << " " << p.y << '\n';
+    for (int j = 0; j < numRows; j++)
+    {
+        for (int i = 0; i < numColumns; i++)
+        {
+            writer << 2 * numBends + 6 << " " << corner(i, j) << " " << middle(i, j) << " " << corner(i + 1, j);
+            for (int k = 0; k < numBends; k++)
+                writer << " " << bend(i + 1, j, k);
+            writer << " " << corner(i + 1, j + 1) << " " << middle(i, j + 1) << " " << corner(i, j + 1);
+            for (int k = numBends - 1; k >= 0; k--)
+                writer << " " << bend(i, j, k);
+            writer << '\n';
+        }
+    }
+    writer.close();
+}
+
+// Returns true if p is inside or on the boundary of the left face of e, which may be any simple polygon
+bool in_polygon(point p, edge* e)
+{
+    assert(e -> leftfaceLabel() != 0);
+    bool inside = false;
+    for (edge &face_edge: *e)
+    {
+        point a = face_edge.originPosition(), b = face_edge.destinationPosition();
+        if (orientation(a, b, p) == 0 and std::min(a.x, b.x) <= p.x and p.x <= std::max(a.x, b.x) and std::min(a.y, b.y) <= p.y and p.y <= std::max(a.y, b.y))
+            return true;
+        // Crossings of a ray from p to the right
+        if ((a.y > p.y) != (b.y > p.y) and p.x < a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y))
+            inside = !inside;
+    }
+    return inside;
+}
+
+// Locates random points (some outside of the plane), points on the sides of the faces and the vertices of a subdivision with non-convex faces through triangulated_subdivision with several hidden locators,
+//      against the trapezoidal map, which handles any face on its own
+void compare_point_locators_in_zigzag_subdivision(int numColumns, int numRows, int numBends)
+{
+    int cellSize = 1000;
+    int right = numColumns * cellSize, top = numRows * cellSize;
+    write_random_zigzag_subdivision(numColumns, numRows, numBends, cellSize, "temp.txt");
+    std::ifstream reader("temp.txt");
+    assert(reader.is_open());
+    plane pl;
+    pl.read_OFF_file(reader);
+    reader.close();
+
+    int numRandomPoints = numColumns * numRows * 10;
+    uniform_point_rng rng(-0.1 * right, 1.1 * top, 1.1 * right, -0.1 * top);
+    std::vector <point> locating = rng.getRandom(numRandomPoints);
+    // Points on the horizontal sides of every cell and on the left and right sides of the plane, which lie on an edge of one face or two
+    for (int j = 0; j <= numRows; j++)
+        for (int i = 0; i < numColumns; i++)
+            locating.push_back(point(i * cellSize + cellSize / 4.0, j * cellSize));
+    for (int j = 0; j < numRows; j++)
+    {
+        locating.push_back(point(0, j * cellSize + cellSize / (2.0 * (numBends + 1))));
+        locating.push_back(point(right, j * cellSize + cellSize / (2.0 * (numBends + 1))));
+    }
+    int numPoints = locating.size();
+    for (edge* e: pl.traverse(primalGraph, traverseNodes))
+        locating.push_back(e -> originPosition());
+    std::vector <edge*> located(locating.size());
+
+    std::unique_ptr <point_location> quadtree_ptr = std::make_unique<naive_quadtree>(90, 60);
+    std::unique_ptr <point_location> trapezoid_ptr = std::make_unique<trapezoidal_map>();
+    std::unique_ptr <walking_scheme> walk_ptr = std::make_unique<lawson_oriented_walk>(lawson_oriented_walk({stochasticWalk, rememberingWalk}));
+    std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(selectGrid));
+    std::unique_ptr <point_location> walking_ptr = std::make_unique<walking_point_location>(walk_ptr, selector_ptr);
+    triangulated_subdivision triangulated_quadtree(quadtree_ptr), triangulated_trapezoid(trapezoid_ptr), triangulated_walk(walking_ptr);
+    trapezoidal_map trapezoid_locator;
+
+    std::vector <named_locator> locators = {{"trapezoidal map", &trapezoid_locator},
+                                            {"triangulated quadtree", &triangulated_quadtree},
+                                            {"triangulated trapezoidal map", &triangulated_trapezoid},
+                                            {"triangulated oriented walk", &triangulated_walk}};
+    for (const named_locator &entry: locators)
+    {
+        const std::string &name = entry.first;
+        point_location &locator = *entry.second;
+
+        startTimer();
+        locator.init(pl);
+        endTimer();
+        print_time("constructing " + name + " on zigzag subdivision");
+
+        startTimer();
+        locator.locate_batch(locating.data(), locating.size(), located.data());
+        endTimer();
+        print_time("locating with " + name + " on zigzag subdivision");
+
+        int numCorrect = 0;
+        for (int i = 0; i < locating.size(); i++)
+        {
+            point p = locating[i];
+            bool expected_in_plane = p.x >= 0 and p.x <= right and p.y >= 0 and p.y <= top;
+            if (expected_in_plane == (located[i] != nullptr) and (!expected_in_plane or in_polygon(p, located[i])))
+                numCorrect++;
+        }
+        print_percent_correct("compare_point_locators_in_zigzag_subdivision " + name, numCorrect, locating.size());
+
+        // Vertices are located onto themselves
+        numCorrect = 0;
+        int numVertices = 0;
+        for (int i = numPoints; i < locating.size(); i++, numVertices++)
+        {
+            location found = locator.locate_ex(locating[i]);
+            if (found.type == onVertex and found.e -> originPosition() == locating[i] and in_polygon(locating[i], found.e))
+                numCorrect++;
+        }
+        print_percent_correct("compare_point_locators_in_zigzag_subdivision locate_ex of vertices with " + name, numCorrect, numVertices);
+    }
+}
+
+// Loads a subdivision with non-triangular faces through read_OFF_file and runs the same random queries through every locator
+void compare_point_locators_in_quadrilateral_subdivision(const std::vector <named_locator> &locators, int numColumns, int numRows)
+{
+    int cellSize = 1000;
+    int right = numColumns * cellSize, top = numRows * cellSize;
+    write_random_quadrilateral_subdivision(numColumns, numRows, cellSize, "temp.txt");
+
+    std::ifstream reader("temp.txt");
+    assert(reader.is_open());
+    plane pl;
+    startTimer();
+    pl.read_OFF_file(reader);
+    endTimer();
+    reader.close();
+    print_time("Reading quadrilateral subdivision");
+
+    int numPoints = numColumns * numRows;
+    uniform_point_rng rng(-0.1 * right, 1.1 * top, 1.1 * right, -0.1 * top);
+    std::vector <point> locating = rng.getRandom(numPoints);
+    std::vector <edge*> located(numPoints);
+
+    for (const named_locator &entry: locators)
+    {
+        const std::string &name = entry.first;
+        point_location &locator = *entry.second;
+
+        startTimer();
+        locator.init(pl);
+        endTimer();
+        print_time("constructing " + name + " on quadrilateral subdivision");
+
+        startTimer();
+        for (int i = 0; i < numPoints; i++)
+            located[i] = locator.locate(locating[i]);
+        endTimer();
+        print_time("locating with " + name + " on quadrilateral subdivision");
+
+        int numCorrect = 0;
+        for (int i = 0; i < numPoints; i++)
+        {
+            point p = locating[i];
+            bool expected_in_plane = p.x >= 0 and p.x <= right and p.y >= 0 and p.y <= top;
+            if (expected_in_plane == (located[i] != nullptr) and (!expected_in_plane or in_face(p, located[i])))
+                numCorrect++;
+        }
+        print_percent_correct("compare_point_locators_in_quadrilateral_subdivision " + name, numCorrect, numPoints);
+    }
+}
+
+void test_rng_distribution()
+{
+    int numPoints = 50000000;
+    startTimer();
+    int left = -99, top = 51, right = 101, bottom = -49;
+
+    uniform_point_rng rng(left, top, right, bottom);
+
+    int buckets = 20;
+    int xtenths[buckets];
+    int yfifths[buckets];
+    for (int i = 0; i < buckets; i++)
+    {
+        xtenths[i] = yfifths[i] = 0;
+    }
+
+    for (int i = 0; i < numPoints; i++)
+    {
+        point p = rng.getRandom();
+        int xbucket = (int) (p.x - left) / 10;
+        int ybucket = (int) (p.y - bottom) / 5;
+        if(xbucket >= 0 and xbucket < buckets and ybucket >= 0 and ybucket < buckets)
+        {
+            xtenths[xbucket]++;
+            yfifths[ybucket]++;
+        }
+    }
+    int minx, maxx, miny, maxy;
+    for (int i = 0; i < buckets; i++)
+    {
+        std::cout<<"i : " << i << " Xtenths: " << xtenths[i] << " Yfifths: " << yfifths[i] << std::endl;
+        assert(xtenths[i] > 0 and yfifths[i] > 0);
+        if (i == 0)
+        {
+            minx = maxx = xtenths[i];
+            miny = maxy = yfifths[i];
+        }
+        else
+        {
+            miny = std::min(miny, yfifths[i]);
+            maxy = std::max(maxy, yfifths[i]);
+            minx = std::min(minx, xtenths[i]);
+            maxx = std::max(maxx, xtenths[i]);
+        }
+    }
+
+    bool allSame = true;
+    uniform_point_rng rng2(left, top, right, bottom);
+    for (int i = 0; i < numPoints; i++)
+    {
+        point p = rng.getRandom();
+        point p2 = rng2.getRandom();
+        if (p != p2)
+            allSame = false;
+    }
+
+    double threshold = 1.01;
+    double x_rat = (double) maxx / minx;
+    double y_rat = (double) maxy / miny;
+    int passed, total;
+    passed = total = 3;
+    if (x_rat > threshold)
+    {
+        std::cout << "Some X values show up too often compared to others" << std::endl;
+        --passed;
+    }
+    if (y_rat > threshold)
+    {
+        std::cout << "Some Y values show up too often compared to others" << std::endl;
+        --passed;
+    }
+    if (allSame)
+    {
+        std::cout << "Different generators produce same sequence of numbers" << std::endl;
+        --passed;
     }
     print_percent_correct("test_rng_distribution", passed, total);
     endTimer();
 }
 
+// Compares walks started from the best edge of a random sample against walks started from the grid cell of the query point
+// Both locators are measured on queries in a finished triangulation and while inserting the points of a new one
+void benchmark_starting_edge_selection(int numPoints)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> locating = rng.getRandom(numPoints);
+    std::vector <edge*> located(numPoints);
+
+    for (selectorMode mode: {selectSample, selectGrid})
+    {
+        // Short walks from the grid gain nothing from fast walking
+        lawson_oriented_walk* walk = mode == selectSample ? new lawson_oriented_walk({fastRememberingWalk}, std::pow(numPoints, 1.0/4.0))
+                                                          : new lawson_oriented_walk({rememberingWalk});
+        std::unique_ptr <walking_scheme> locator_ptr(walk);
+        std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(mode == selectSample ? starting_edge_selector(selectSample, std::pow(numPoints, 1.0/3.0))
+                                                                                                                          : starting_edge_selector(selectGrid));
+        walking_point_location locator(locator_ptr, selector_ptr);
+        std::string name = mode == selectSample ? "sampled starting edges" : "grid starting edges";
+        locator.init(tr);
+
+        startTimer();
+        for (int i = 0; i < numPoints; i++)
+            located[i] = locator.locate(locating[i]);
+        endTimer();
+        print_time("locating with " + name);
+        std::cout << "Faces walked per query with " << name << ": " << (double) walk -> numFaces / numPoints << std::endl;
+
+        int numCorrect = 0;
+        for (int i = 0; i < numPoints; i++)
+        {
+            if (correctly_located(locating[i], located[i], left, top, right, bottom))
+                numCorrect++;
+        }
+        print_percent_correct("benchmark_starting_edge_selection " + name, numCorrect, numPoints);
+
+        triangulation built;
+        walk -> numFaces = 0;
+        startTimer();
+        built.generateRandomTriangulation(numPoints, locator, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+        endTimer();
+        print_time("triangulating with " + name);
+        std::cout << "Faces walked per inserted point with " << name << ": " << (double) walk -> numFaces / numPoints << std::endl;
+    }
+}
+
+// Walks from the same starting edge to every query point with the walk compiled for one combination of options
+template <bool isStochastic, bool isRemembering, bool isFast>
+void benchmark_lawson_walk_policy(const std::string &name, edge* start, const std::vector <point> &locating, unsigned int fastSteps, int left, int top, int right, int bottom)
+{
+    lawson_walk <isStochastic, isRemembering, isFast> walk(fastSteps);
+    std::vector <edge*> located(locating.size());
+
+    startTimer();
+    for (int i = 0; i < locating.size(); i++)
+        located[i] = walk.locate(start, locating[i]);
+    double t = endTimer();
+    std::cout << "Time per face walked with " << name << ": " << t * 1e9 / walk.numFaces << " ns (" << (double) walk.numFaces / locating.size() << " faces per query)" << std::endl;
+
+    int numCorrect = 0;
+    for (int i = 0; i < locating.size(); i++)
+    {
+        if (correctly_located(locating[i], located[i], left, top, right, bottom))
+            numCorrect++;
+    }
+    print_percent_correct("benchmark_lawson_walk_policies " + name, numCorrect, locating.size());
+}
+
+// Long walks (all starting from the same edge) so that the time per face is dominated by the steps of the walk
+void benchmark_lawson_walk_policies(int numPoints, int numQueries)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> locating = rng.getRandom(numQueries);
+    edge* start = tr.traverse(primalGraph, traverseEdges)[0];
+    unsigned int fastSteps = std::pow(numPoints, 1.0/4.0);
+
+    benchmark_lawson_walk_policy<false, false, false>("plain walk", start, locating, 0, left, top, right, bottom);
+    benchmark_lawson_walk_policy<false, true, false>("remembering walk", start, locating, 0, left, top, right, bottom);
+    benchmark_lawson_walk_policy<false, true, true>("fast remembering walk", start, locating, fastSteps, left, top, right, bottom);
+    benchmark_lawson_walk_policy<true, false, false>("stochastic walk", start, locating, 0, left, top, right, bottom);
+    benchmark_lawson_walk_policy<true, true, false>("stochastic remembering walk", start, locating, 0, left, top, right, bottom);
+    benchmark_lawson_walk_policy<true, true, true>("stochastic fast remembering walk", start, locating, fastSteps, left, top, right, bottom);
+}
+
+// Runs the same queries through one locator shared by an increasing number of threads
+// At least 4 threads are always used, so that machines with fewer cores still exercise the query contexts and the work stealing
+void benchmark_parallel_queries(int numPoints, int numQueries)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> locating = rng.getRandom(numQueries);
+    std::vector <edge*> located(numQueries);
+
+    std::unique_ptr <walking_scheme> locator_ptr = std::make_unique<lawson_oriented_walk>(lawson_oriented_walk({rememberingWalk}));
+    std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(selectGrid));
+    std::vector <std::pair <std::string, std::unique_ptr <point_location>>> locators;
+    locators.emplace_back("slab decomposition", std::make_unique<slab_decomposition>());
+    locators.emplace_back("linear quadtree", std::make_unique<naive_quadtree>(90, 60, linearQuadtree));
+    locators.emplace_back("uniform grid of centroid faces", std::make_unique<uniform_grid>(1.0, centroidFaces));
+    locators.emplace_back("oriented walk", std::make_unique<walking_point_location>(locator_ptr, selector_ptr));
+
+    int maxThreads = std::max(4u, std::thread::hardware_concurrency());
+    for (auto &entry: locators)
+    {
+        entry.second -> init(tr);
+        for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+        {
+            work_stealing_pool pool(numThreads);
+            std::string name = entry.first + " with " + std::to_string(numThreads) + " threads";
+
+            startTimer();
+            locate_parallel(*entry.second, locating.data(), numQueries, located.data(), pool);
+            print_throughput(name, numQueries, endTimer());
+
+            int numCorrect = 0;
+            for (int i = 0; i < numQueries; i++)
+            {
+                if (correctly_located(locating[i], located[i], left, top, right, bottom))
+                    numCorrect++;
+            }
+            print_percent_correct("benchmark_parallel_queries " + name, numCorrect, numQueries);
+        }
+        entry.second.reset();
+    }
+}
+
+// Walks a batch of queries in the given order and in Hilbert order, with each walk starting from the previous answer when that is closer
+// Queries outside the triangulation still walk to its boundary, so they keep the average above a few faces per query
+void benchmark_hilbert_sorted_walks(int numPoints, int numQueries, selectorMode mode)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> locating = rng.getRandom(numQueries);
+    std::vector <edge*> located(numQueries);
+
+    std::string selector_name = mode == selectRecent ? "recent" : "grid";
+    std::vector <std::pair <std::string, batchWalkOrder>> orders = {{"given order", givenOrder}, {"hilbert order", hilbertSortedOrder}};
+    for (auto &order: orders)
+    {
+        lawson_oriented_walk* walk = new lawson_oriented_walk({rememberingWalk});
+        std::unique_ptr <walking_scheme> locator_ptr(walk);
+        std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(mode));
+        walking_point_location locator(locator_ptr, selector_ptr);
+        locator.init(tr);
+        locator.setBatchOrder(order.second);
+        std::string name = std::to_string(numQueries) + " queries in " + order.first + " from " + selector_name + " starting edges";
+
+        startTimer();
+        locator.locate_batch(locating.data(), numQueries, located.data());
+        print_throughput(name, numQueries, endTimer());
+        std::cout << "Faces walked per query with " << name << ": " << (double) walk -> numFaces / numQueries << std::endl;
+
+        int numCorrect = 0;
+        for (int i = 0; i < numQueries; i++)
+        {
+            if (correctly_located(locating[i], located[i], left, top, right, bottom))
+                numCorrect++;
+        }
+        print_percent_correct("benchmark_hilbert_sorted_walks " + name, numCorrect, numQueries);
+    }
+}
+
+// Queries/s of interleaved walks as a function of the number of walks kept in progress, on a mesh much larger than the caches
+// Grid starts give short walks (a few faces each), walks from a single edge are long and spend almost all of their time on cache misses
+void benchmark_interleaved_walks(int numPoints, int numQueries)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> locating = rng.getRandom(numQueries);
+    std::vector <edge*> located(numQueries);
+    int numLongWalks = numQueries / 100;
+    std::vector <edge*> starts(numLongWalks, tr.traverse(primalGraph, traverseEdges)[0]);
+
+    for (int width: {1, 2, 4, 8, 16, 32, 64})
+    {
+        lawson_oriented_walk* walk = new lawson_oriented_walk({rememberingWalk});
+        walk -> setInterleaveWidth(width);
+        std::unique_ptr <walking_scheme> locator_ptr(walk);
+        std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(selectGrid));
+        walking_point_location locator(locator_ptr, selector_ptr);
+        locator.init(tr);
+        locator.setBatchStarts(selectorStarts);
+        std::string name = "walks from grid starting edges with interleave width " + std::to_string(width);
+
+        startTimer();
+        locator.locate_batch(locating.data(), numQueries, located.data());
+        print_throughput(name, numQueries, endTimer());
+
+        int numCorrect = 0;
+        for (int i = 0; i < numQueries; i++)
+        {
+            if (correctly_located(locating[i], located[i], left, top, right, bottom))
+                numCorrect++;
+        }
+        print_percent_correct("benchmark_interleaved_walks " + name, numCorrect, numQueries);
+
+        lawson_oriented_walk long_walk({rememberingWalk});
+        long_walk.setInterleaveWidth(width);
+        name = "walks from a single edge with interleave width " + std::to_string(width);
+
+        startTimer();
+        long_walk.locate_batch(starts.data(), locating.data(), numLongWalks, located.data());
+        double t = endTimer();
+        print_throughput(name, numLongWalks, t);
+        std::cout << "Time per face walked with " << name << ": " << t * 1e9 / long_walk.numFaces << " ns" << std::endl;
+
+        numCorrect = 0;
+        for (int i = 0; i < numLongWalks; i++)
+        {
+            if (correctly_located(locating[i], located[i], left, top, right, bottom))
+                numCorrect++;
+        }
+        print_percent_correct("benchmark_interleaved_walks " + name, numCorrect, numLongWalks);
+    }
+}
+
+// Fast remembering walks from a single edge, one walk at a time against SIMD lanes advancing in lockstep (and interleaved walks for reference)
+void benchmark_lockstep_walks(int numPoints, int numQueries)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> locating = rng.getRandom(numQueries);
+    std::vector <edge*> located(numQueries);
+    std::vector <edge*> starts(numQueries, tr.traverse(primalGraph, traverseEdges)[0]);
+    unsigned int fastSteps = std::pow(numPoints, 1.0/4.0);
+
+    std::vector <std::pair <std::string, lawsonWalkOptions>> walks = {{"scalar walk", fastRememberingWalk}, {"interleaved walk", fastRememberingWalk}, {"lockstep walk", lockstepWalk}};
+    for (auto &entry: walks)
+    {
+        lawson_oriented_walk walk({entry.second}, fastSteps);
+        if (entry.first == "interleaved walk")
+            walk.setInterleaveWidth(32);
+
+        startTimer();
+        walk.locate_batch(starts.data(), locating.data(), numQueries, located.data());
+        double t = endTimer();
+        print_throughput(entry.first, numQueries, t);
+        std::cout << "Time per face walked with " << entry.first << ": " << t * 1e9 / walk.numFaces << " ns (" << (double) walk.numFaces / numQueries << " faces per query)" << std::endl;
+
+        int numCorrect = 0;
+        for (int i = 0; i < numQueries; i++)
+        {
+            if (correctly_located(locating[i], located[i], left, top, right, bottom))
+                numCorrect++;
+        }
+        print_percent_correct("benchmark_lockstep_walks " + entry.first, numCorrect, numQueries);
+    }
+}
+
+// Builds delaunay triangulations with non-walking locators kept up to date through addEdge and removeEdge,
+// then checks the triangulation and locates random points with the same locators, which now index the finished mesh
+// Locators rebuilt from scratch on every insertion (the linear quadtree) only get a small triangulation
+void test_online_point_location(int numPoints, int numSmallPoints)
+{
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+
+    naive_quadtree quad_locator(90, 60), linear_quad_locator(90, 60, linearQuadtree);
+    slab_decomposition slab_locator, btree_slab_locator(btreeLayout);
+    std::unique_ptr <walking_scheme> locator_ptr = std::make_unique<lawson_oriented_walk>(lawson_oriented_walk({rememberingWalk}));
+    std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(selectGrid));
+    walking_point_location walk_locator(locator_ptr, selector_ptr);
+
+    std::vector <std::tuple <std::string, online_point_location*, int>> locators = {{"oriented walk", &walk_locator, numPoints},
+        {"quadtree", &quad_locator, numPoints}, {"oriented walk", &walk_locator, numSmallPoints}, {"linear quadtree", &linear_quad_locator, numSmallPoints},
+        {"slab decomposition", &slab_locator, numSmallPoints}, {"B-tree slab decomposition", &btree_slab_locator, numSmallPoints}};
+    for (auto &entry: locators)
+    {
+        std::string name = std::get<0>(entry) + " (" + std::to_string(std::get<2>(entry)) + " points)";
+        online_point_location &locator = *std::get<1>(entry);
+        triangulation tr;
+        startTimer();
+        tr.generateRandomTriangulation(std::get<2>(entry), locator, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+        endTimer();
+        print_time("triangulating with online " + name);
+
+        int numCorrect = 0, total = 0;
+        for (edge* e: tr.traverse(primalGraph, traverseEdges))
+        {
+            total++;
+            if (fulfills_delaunay(e))
+                numCorrect++;
+        }
+        print_percent_correct("test_online_point_location delaunay condition with " + name, numCorrect, total);
+
+        std::vector <point> locating = rng.getRandom(std::get<2>(entry));
+        numCorrect = 0;
+        for (point p: locating)
+        {
+            if (correctly_located(p, locator.locate(p), left, top, right, bottom))
+                numCorrect++;
+        }
+        print_percent_correct("test_online_point_location locating with " + name, numCorrect, locating.size());
+    }
+}
+
+// Compares the nearest neighbor queries of a delaunay triangulation (started from a grid walk) against a kd-tree built on the same points
+// The triangulation needs no memory besides its locator, the kd-tree is a second copy of the points
+void benchmark_nearest_neighbors(int numPoints, int numQueries, int k)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> locating = rng.getRandom(numQueries);
+
+    std::unique_ptr <walking_scheme> locator_ptr = std::make_unique<lawson_oriented_walk>(lawson_oriented_walk({rememberingWalk}));
+    std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(selectGrid));
+    walking_point_location locator(locator_ptr, selector_ptr);
+    locator.init(tr);
+
+    kd_tree tree;
+    startTimer();
+    tree.init(tr);
+    print_time("building the kd-tree", endTimer());
+    std::cout << "kd-tree memory: " << tree.getMemoryUsage() << " bytes" << std::endl;
+
+    std::vector <std::vector <vertex*>> expected(numQueries), found(numQueries);
+    std::vector <vertex*> nearest(numQueries);
+    startTimer();
+    for (int i = 0; i < numQueries; i++)
+        expected[i] = tree.kNearest(locating[i], 1);
+    print_throughput("nearest point with kd-tree", numQueries, endTimer());
+
+    startTimer();
+    for (int i = 0; i < numQueries; i++)
+        nearest[i] = tr.nearestVertex(locating[i], locator);
+    print_throughput("nearestVertex", numQueries, endTimer());
+    int numCorrect = 0;
+    for (int i = 0; i < numQueries; i++)
+    {
+        if (same_nearest(locating[i], {nearest[i]}, expected[i]))
+            numCorrect++;
+    }
+    print_percent_correct("benchmark_nearest_neighbors nearestVertex", numCorrect, numQueries);
+
+    startTimer();
+    tr.nearestVertex_batch(locating.data(), numQueries, nearest.data(), locator);
+    print_throughput("nearestVertex_batch", numQueries, endTimer());
+    numCorrect = 0;
+    for (int i = 0; i < numQueries; i++)
+    {
+        if (same_nearest(locating[i], {nearest[i]}, expected[i]))
+            numCorrect++;
+    }
+    print_percent_correct("benchmark_nearest_neighbors nearestVertex_batch", numCorrect, numQueries);
+
+    std::string name = std::to_string(k) + " nearest points";
+    startTimer();
+    for (int i = 0; i < numQueries; i++)
+        expected[i] = tree.kNearest(locating[i], k);
+    print_throughput(name + " with kd-tree", numQueries, endTimer());
+
+    startTimer();
+    for (int i = 0; i < numQueries; i++)
+        found[i] = tr.kNearest(locating[i], k, locator);
+    print_throughput(name + " with kNearest", numQueries, endTimer());
+    numCorrect = 0;
+    for (int i = 0; i < numQueries; i++)
+    {
+        if (same_nearest(locating[i], found[i], expected[i]))
+            numCorrect++;
+    }
+    print_percent_correct("benchmark_nearest_neighbors kNearest", numCorrect, numQueries);
+
+    startTimer();
+    tr.kNearest_batch(locating.data(), numQueries, k, found.data(), locator);
+    print_throughput(name + " with kNearest_batch", numQueries, endTimer());
+    numCorrect = 0;
+    for (int i = 0; i < numQueries; i++)
+    {
+        if (same_nearest(locating[i], found[i], expected[i]))
+            numCorrect++;
+    }
+    print_percent_correct("benchmark_nearest_neighbors kNearest_batch", numCorrect, numQueries);
+}
+
+// Compares faces_in_box (and its parallel version) against scanning every face of the triangulation, for boxes covering a growing share of the plane
+// The flood fill is output sensitive, so its advantage shrinks as the boxes grow while the full scan always costs the same
+void benchmark_faces_in_box(int numPoints, int numBoxes)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+
+    std::unique_ptr <walking_scheme> locator_ptr = std::make_unique<lawson_oriented_walk>(lawson_oriented_walk({rememberingWalk}));
+    std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(selectGrid));
+    walking_point_location locator(locator_ptr, selector_ptr);
+    locator.init(tr);
+
+    auto labels_of = [](const std::vector <edge*> &faces)
+    {
+        std::vector <int> labels;
+        for (edge* e: faces)
+            labels.push_back(e -> leftfaceLabel());
+        std::sort(labels.begin(), labels.end());
+        return labels;
+    };
+
+    for (double side: {0.001, 0.01, 0.1, 1.0})
+    {
+        // Boxes are squares with the given fraction of the side of the plane, some of them sticking out of it
+        T width = side * (right - left);
+        uniform_point_rng rng(left - width / 2, top, right - width / 2, bottom - width / 2);
+        std::vector <point> corners = rng.getRandom(numBoxes);
+        std::string name = "boxes of side " + std::to_string(side);
+
+        std::vector <std::vector <edge*>> scanned(numBoxes), filled(numBoxes), filled_parallel(numBoxes);
+        startTimer();
+        for (int i = 0; i < numBoxes; i++)
+        {
+            auto query = std::make_tuple(corners[i].x, corners[i].y + width, corners[i].x + width, corners[i].y);
+            for (edge* face: tr.traverse(dualGraph, traverseNodes))
+            {
+                if (face -> origin().getLabel() != 0 and boxOverlapsFace(query, face, faceBoundingBox(face)))
+                    scanned[i].push_back(face -> rot());
+            }
+        }
+        print_throughput(name + " with a full scan", numBoxes, endTimer());
+
+        startTimer();
+        for (int i = 0; i < numBoxes; i++)
+            filled[i] = tr.faces_in_box(corners[i].x, corners[i].y + width, corners[i].x + width, corners[i].y, locator);
+        print_throughput(name + " with faces_in_box", numBoxes, endTimer());
+
+        startTimer();
+        for (int i = 0; i < numBoxes; i++)
+            filled_parallel[i] = tr.faces_in_box_parallel(corners[i].x, corners[i].y + width, corners[i].x + width, corners[i].y, locator);
+        print_throughput(name + " with faces_in_box_parallel", numBoxes, endTimer());
+
+        int numCorrect = 0;
+        size_t numFound = 0;
+        for (int i = 0; i < numBoxes; i++)
+        {
+            std::vector <int> expected = labels_of(scanned[i]);
+            if (labels_of(filled[i]) == expected and labels_of(filled_parallel[i]) == expected)
+                numCorrect++;
+            numFound += expected.size();
+        }
+        std::cout << "Faces per box for " << name << ": " << (double) numFound / numBoxes << std::endl;
+        print_percent_correct("benchmark_faces_in_box " + name, numCorrect, numBoxes);
+    }
+}
+
+// Returns true if the closed segments m and n share a point
+bool segments_touch(const point m[2], const point n[2])
+{
+    T o1 = orientation(m[0], m[1], n[0]), o2 = orientation(m[0], m[1], n[1]);
+    T o3 = orientation(n[0], n[1], m[0]), o4 = orientation(n[0], n[1], m[1]);
+    if (o1 == 0 and o2 == 0)
+        return std::max(std::min(m[0].x, m[1].x), std::min(n[0].x, n[1].x)) <= std::min(std::max(m[0].x, m[1].x), std::max(n[0].x, n[1].x)) and
+               std::max(std::min(m[0].y, m[1].y), std::min(n[0].y, n[1].y)) <= std::min(std::max(m[0].y, m[1].y), std::max(n[0].y, n[1].y));
+    return o1 * o2 <= 0 and o3 * o4 <= 0;
+}
+
+// Returns true if path is the straight walk from a to b: it starts in the face containing a, every crossed edge touches the segment
+//      and leads from the previous face into the next one, and the walk ends in the face containing b (unless b is outside of the plane)
+bool correct_straight_walk(point a, point b, const std::vector <edge*> &path, triangulation &tr)
+{
+    T left, top, right, bottom;
+    std::tie(left, top, right, bottom) = tr.bounds;
+    auto in_plane = [&](point p){return p.x >= left and p.x <= right and p.y >= bottom and p.y <= top;};
+    if (path.empty())
+        return !in_plane(a);
+    if (!in_face(a, path[0]))
+        return false;
+    point segment[2] = {a, b};
+    for (int i = 1; i < path.size(); i++)
+    {
+        point crossed[2] = {path[i] -> originPosition(), path[i] -> destinationPosition()};
+        if (!segments_touch(segment, crossed))
+            return false;
+        // Faces are entered across an edge of the previous face or through one of its vertices on the segment
+        bool from_previous_face = false;
+        for (edge &face_edge: *path[i - 1])
+        {
+            point vertex_on_segment[2] = {crossed[0], crossed[0]};
+            from_previous_face |= &face_edge == path[i] -> twin();
+            from_previous_face |= face_edge.originPosition() == crossed[0] and segments_touch(segment, vertex_on_segment);
+        }
+        if (!from_previous_face)
+            return false;
+    }
+    return !in_plane(b) or in_face(b, path.back());
+}
+
+// Reads a triangulation of the integer grid [0, size] x [0, size] whose squares are split along one diagonal
+// Segments between grid points pass through vertices and run along edges, which are the degenerate cases of straight walks
+void read_grid_triangulation(triangulation &tr, int size)
+{
+    std::stringstream off;
+    int numPoints = (size + 1) * (size + 1), numFaces = 2 * size * size;
+    off << "OFF" << '\n' << numPoints << " " << numFaces << " " << numPoints + numFaces - 1 << '\n';
+    for (int y = 0; y <= size; y++)
+        for (int x = 0; x <= size; x++)
+            off << x << " " << y << '\n';
+    auto index = [size](int x, int y){return y * (size + 1) + x;};
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            off << "3 " << index(x, y) << " " << index(x + 1, y) << " " << index(x + 1, y + 1) << '\n';
+            off << "3 " << index(x, y) << " " << index(x + 1, y + 1) << " " << index(x, y + 1) << '\n';
+        }
+    }
+    tr.read_OFF_file(off);
+}
+
+// Checks straight walks between random points (some outside of the plane) of a random triangulation and between the vertices of a grid
+void test_straight_walks(int numPoints, int numSegments)
+{
+    triangulation random_tr, grid_tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    random_tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> random_points = rng.getRandom(numSegments + 1);
+
+    int size = 20;
+    read_grid_triangulation(grid_tr, size);
+    std::vector <point> grid_points;
+    for (point p: uniform_point_rng(0, size + 1, size + 1, 0).getRandom(numSegments + 1))
+        grid_points.push_back(point(std::min(std::floor(p.x), (T) size), std::min(std::floor(p.y), (T) size)));
+
+    std::vector <std::tuple <std::string, triangulation*, std::vector <point>*>> cases = {{"random triangulation", &random_tr, &random_points},
+                                                                                         {"grid triangulation", &grid_tr, &grid_points}};
+    for (auto &entry: cases)
+    {
+        triangulation &tr = *std::get<1>(entry);
+        std::vector <point> &points = *std::get<2>(entry);
+        std::unique_ptr <walking_scheme> locator_ptr = std::make_unique<lawson_oriented_walk>(lawson_oriented_walk({stochasticWalk, rememberingWalk}));
+        std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(selectGrid));
+        walking_point_location locator(locator_ptr, selector_ptr);
+        locator.init(tr);
+
+        int numCorrect = 0;
+        for (int i = 0; i < numSegments; i++)
+        {
+            if (correct_straight_walk(points[i], points[i + 1], tr.walkSegment(points[i], points[i + 1], locator), tr))
+                numCorrect++;
+        }
+        print_percent_correct("test_straight_walks walkSegment in " + std::get<0>(entry), numCorrect, numSegments);
+
+        std::vector <std::vector <edge*>> paths(numSegments);
+        tr.walkPolyline(points.data(), numSegments + 1, paths.data(), locator);
+        numCorrect = 0;
+        for (int i = 0; i < numSegments; i++)
+        {
+            if (correct_straight_walk(points[i], points[i + 1], paths[i], tr))
+                numCorrect++;
+        }
+        print_percent_correct("test_straight_walks walkPolyline in " + std::get<0>(entry), numCorrect, numSegments);
+    }
+}
+
+// Measures straight walks along random independent segments (each starting point located again) and along polylines of the same step length
+void benchmark_straight_walks(int numPoints, int numSegments, double step)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+
+    std::unique_ptr <walking_scheme> locator_ptr = std::make_unique<lawson_oriented_walk>(lawson_oriented_walk({rememberingWalk}));
+    std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(selectGrid));
+    walking_point_location locator(locator_ptr, selector_ptr);
+    locator.init(tr);
+
+    // A polyline moves by step times the side of the plane in a random direction at every point, bouncing off the sides of the plane
+    T length = step * (right - left);
+    uniform_point_rng rng(left, top, right, bottom), directions(-1, 1, 1, -1);
+    std::vector <point> polyline = {rng.getRandom()};
+    for (point d: directions.getRandom(numSegments))
+    {
+        point next = polyline.back() + (length / std::sqrt(dot(d, d))) * d;
+        next.x = std::max((T) left, std::min((T) right, next.x));
+        next.y = std::max((T) bottom, std::min((T) top, next.y));
+        polyline.push_back(next);
+    }
+    std::string name = "segments of length " + std::to_string(step);
+
+    std::vector <std::vector <edge*>> paths(numSegments);
+    size_t numFaces = 0;
+    startTimer();
+    for (int i = 0; i < numSegments; i++)
+        paths[i] = tr.walkSegment(polyline[i], polyline[i + 1], locator);
+    print_throughput(name + " with walkSegment", numSegments, endTimer());
+
+    startTimer();
+    tr.walkPolyline(polyline.data(), numSegments + 1, paths.data(), locator);
+    print_throughput(name + " with walkPolyline", numSegments, endTimer());
+
+    int numCorrect = 0;
+    for (int i = 0; i < numSegments; i++)
+    {
+        numFaces += paths[i].size();
+        if (correct_straight_walk(polyline[i], polyline[i + 1], paths[i], tr))
+            numCorrect++;
+    }
+    std::cout << "Faces crossed per segment for " << name << ": " << (double) numFaces / numSegments << std::endl;
+    print_percent_correct("benchmark_straight_walks " + name, numCorrect, numSegments);
+}
+
+// Returns true if p is inside or on the boundary of triangle t of the snapshot
+bool in_frozen_triangle(point p, const frozen_triangulation &frozen, int t)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        if (orientation(frozen.vertexPosition(frozen.vertexIndex(t, i)), frozen.vertexPosition(frozen.vertexIndex(t, (i + 1) % 3)), p) > 0)
+            return false;
+    }
+    return true;
+}
+
+// Walks over a frozen snapshot against walks over the quadedge structure, then checks that saved, loaded and shared snapshots give the same answers
+void benchmark_frozen_triangulation(int numPoints, int numQueries)
+{
+    triangulation tr;
+    int left = -10000000, top = 10000000, right = 10000000, bottom = -10000000;
+    double padding_coeff = 1.3; // So that some points are outside bounding box;
+    tr.generateRandomTriangulation(numPoints, delaunayTriangulation, std::make_tuple(left, top, right, bottom));
+
+    uniform_point_rng rng(padding_coeff * left, padding_coeff * top, padding_coeff * right, padding_coeff * bottom);
+    std::vector <point> locating = rng.getRandom(numQueries);
+    std::vector <edge*> located(numQueries);
+    std::vector <int> found(numQueries);
+
+    startTimer();
+    frozen_triangulation frozen = tr.freeze();
+    endTimer();
+    print_time("freezing triangulation");
+
+    // Every quadedge allocates its 4 edges separately, and every vertex and face is a vertex object
+    size_t numEdges = tr.traverse(primalGraph, traverseEdges).size(), numVertices = tr.traverse(primalGraph, traverseNodes).size();
+    size_t quadedge_memory = numEdges * (sizeof(quadedge) + 4 * sizeof(edge)) + (numVertices + frozen.getNumTriangles()) * sizeof(vertex);
+    std::cout << "Memory per triangle -> Quadedge: " << (double) quadedge_memory / frozen.getNumTriangles()
+              << " bytes Frozen: " << (double) frozen.getMemoryUsage() / frozen.getNumTriangles() << " bytes" << std::endl;
+
+    // Same walks and starting edges as the snapshot uses: a sample of n^(1/3) edges for single queries, the previous answer for Hilbert sorted batches
+    std::unique_ptr <walking_scheme> walk_ptr = std::make_unique<lawson_oriented_walk>(lawson_oriented_walk({stochasticWalk, rememberingWalk}));
+    std::unique_ptr <starting_edge_selector> selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(selectSample, std::pow(numPoints, 1.0/3.0)));
+    walking_point_location walk_locator(walk_ptr, selector_ptr);
+    walk_locator.init(tr);
+    std::unique_ptr <walking_scheme> batch_walk_ptr = std::make_unique<lawson_oriented_walk>(lawson_oriented_walk({stochasticWalk, rememberingWalk}));
+    std::unique_ptr <starting_edge_selector> batch_selector_ptr = std::make_unique<starting_edge_selector>(starting_edge_selector(selectRecent));
+    walking_point_location batch_walk_locator(batch_walk_ptr, batch_selector_ptr);
+    batch_walk_locator.init(tr);
+    batch_walk_locator.setBatchOrder(hilbertSortedOrder);
+
+    int numSingleQueries = std::min(numQueries, 10000);
+    startTimer();
+    for (int i = 0; i < numSingleQueries; i++)
+        located[i] = walk_locator.locate(locating[i]);
+    print_throughput("locate with quadedge walk", numSingleQueries, endTimer());
+    startTimer();
+    batch_walk_locator.locate_batch(locating.data(), numQueries, located.data());
+    print_throughput("locate_batch with quadedge walk", numQueries, endTimer());
+
+    startTimer();
+    for (int i = 0; i < numQueries; i++)
+        found[i] = frozen.locate(locating[i]);
+    print_throughput("locate with frozen walk", numQueries, endTimer());
+    startTimer();
+    frozen.locate_batch(locating.data(), numQueries, found.data());
+    print_throughput("locate_batch with frozen walk", numQueries, endTimer());
+
+    int numCorrect = 0;
+    for (int i = 0; i < numQueries; i++)
+    {
+        bool expected_in_box = in_padded_bounding_box(locating[i], left, top, right, bottom);
+        if (expected_in_box == (found[i] != -1) and (!expected_in_box or in_frozen_triangle(locating[i], frozen, found[i])))
+            numCorrect++;
+    }
+    print_percent_correct("benchmark_frozen_triangulation frozen walk", numCorrect, numQueries);
+
+    // Labels of the snapshot are the labels of the faces found by the quadedge walk
+    numCorrect = 0;
+    for (int i = 0; i < numQueries; i++)
+    {
+        if ((located[i] == nullptr) == (found[i] == -1) and (found[i] == -1 or located[i] -> leftfaceLabel() == frozen.faceLabel(found[i])))
+            numCorrect++;
+    }
+    print_percent_correct("benchmark_frozen_triangulation face labels", numCorrect, numQueries);
+
+    // Loaded snapshots and snapshots viewing a buffer (like a memory mapped file) answer the same
+    std::ofstream writer("temp.bin", std::ios::binary);
+    frozen.save(writer);
+    writer.close();
+    std::ifstream reader("temp.bin", std::ios::binary);
+    frozen_triangulation loaded = frozen_triangulation::load(reader);
+    reader.close();
+    std::ifstream buffer_reader("temp.bin", std::ios::binary);
+    std::vector <char> buffer((std::istreambuf_iterator<char>(buffer_reader)), std::istreambuf_iterator<char>());
+    buffer_reader.close();
+    frozen_triangulation viewed(buffer.data(), buffer.size());
+
+    std::vector <int> loaded_found(numQueries), viewed_found(numQueries), shared_found(numQueries);
+    loaded.locate_batch(locating.data(), numQueries, loaded_found.data());
+    viewed.locate_batch(locating.data(), numQueries, viewed_found.data());
+
+    // Threads share one snapshot, each locating its own chunk of the queries
+    int numThreads = std::max(4u, std::thread::hardware_concurrency());
+    int chunk = (numQueries + numThreads - 1) / numThreads;
+    std::vector <std::thread> workers;
+    startTimer();
+    for (int t = 0; t < numThreads; t++)
+    {
+        int first = std::min(t * chunk, numQueries), last = std::min((t + 1) * chunk, numQueries);
+        workers.emplace_back([&, first, last](){frozen.locate_batch(locating.data() + first, last - first, shared_found.data() + first);});
+    }
+    for (std::thread &worker: workers)
+        worker.join();
+    print_throughput("locate_batch with frozen walk on " + std::to_string(numThreads) + " threads", numQueries, endTimer());
+
+    numCorrect = 0;
+    for (int i = 0; i < numQueries; i++)
+    {
+        if (loaded_found[i] == found[i] and viewed_found[i] == found[i] and (shared_found[i] == -1) == (found[i] == -1) and
+            (shared_found[i] == -1 or in_frozen_triangle(locating[i], frozen, shared_found[i])))
+            numCorrect++;
+    }
+    print_percent_correct("benchmark_frozen_triangulation saved and shared snapshots", numCorrect, numQueries);
+
+    // Truncated snapshots and snapshots with an index out of range are rejected instead of being read past their end
+    auto is_rejected = [](auto read)
+    {
+        try
+        {
+            read();
+        }
+        catch (const invalidSnapshotException&)
+        {
+            return true;
+        }
+        return false;
+    };
+    std::vector <char> corrupted = buffer;
+    int32_t out_of_range = frozen.getNumVertices();
+    std::memcpy(corrupted.data() + buffer.size() - 7 * sizeof(int32_t) * frozen.getNumTriangles(), &out_of_range, sizeof(int32_t));
+    std::string truncated(buffer.data(), buffer.size() / 2);
+    int numRejected = 0;
+    numRejected += is_rejected([&](){frozen_triangulation(buffer.data(), buffer.size() - 1);});
+    numRejected += is_rejected([&](){frozen_triangulation(corrupted.data(), corrupted.size());});
+    numRejected += is_rejected([&](){std::istringstream stream(truncated); frozen_triangulation::load(stream);});
+    numRejected += is_rejected([&](){std::istringstream stream("not a snapshot"); frozen_triangulation::load(stream);});
+    print_percent_correct("benchmark_frozen_triangulation rejected invalid snapshots", numRejected, 4);
+}
+
 int main()
 {
     /* Rng Checking */
@@ -273,6 +1845,9 @@ int main()
     /* Delaunay Storage Testing */
     test_saving_delaunay_triangulation(1000);
 
+    test_locate_ex(100000);
+    print_time("test_locate_ex");
+
     /* Point Location Testing */
 
     int numPoints = 100000;
@@ -288,6 +1863,11 @@ int main()
     print_time("test_random_point_location_in_random_arbitrary_triangulation quad");
     */
 
+    naive_quadtree linear_quad_locator(90, 60, linearQuadtree);
+
+    test_random_point_location_in_random_triangulation(linear_quad_locator, numPoints, true);
+    print_time("test_random_point_location_in_random_delaunay_triangulation linear quad");
+
     /* Slab decomposition */
 
     slab_decomposition slab_locator;
@@ -300,6 +1880,39 @@ int main()
     print_time("test_random_point_location_in_random_arbitrary_triangulation slab");
     */
 
+    persistent_slab_decomposition persistent_slab_locator;
+
+    test_random_point_location_in_random_triangulation(persistent_slab_locator, numPoints, true);
+    print_time("test_random_point_location_in_random_delaunay_triangulation persistent slab");
+
+    /* Kirkpatrick hierarchy */
+
+    kirkpatrick_hierarchy kirkpatrick_locator;
+
+    test_random_point_location_in_random_triangulation(kirkpatrick_locator, numPoints, true);
+    print_time("test_random_point_location_in_random_delaunay_triangulation kirkpatrick");
+
+    /* Trapezoidal map */
+
+    trapezoidal_map trapezoid_locator;
+
+    test_random_point_location_in_random_triangulation(trapezoid_locator, numPoints, true);
+    print_time("test_random_point_location_in_random_delaunay_triangulation trapezoid");
+
+    /* Uniform grid */
+
+    uniform_grid grid_locator;
+
+    test_random_point_location_in_random_triangulation(grid_locator, numPoints, true);
+    print_time("test_random_point_location_in_random_delaunay_triangulation grid");
+
+    /* Hilbert R-tree */
+
+    hilbert_rtree rtree_locator;
+
+    test_random_point_location_in_random_triangulation(rtree_locator, numPoints, true);
+    print_time("test_random_point_location_in_random_delaunay_triangulation hilbert rtree");
+
     /* Oriented Walk */
 
     std::unique_ptr <walking_scheme> locator_ptr = std::make_unique<lawson_oriented_walk>(lawson_oriented_walk({stochasticWalk, fastRememberingWalk}, std::pow(numPoints, 1.0/4.0)));
@@ -314,6 +1927,67 @@ int main()
     print_time("test_random_point_location_in_random_arbitrary_triangulation walking");
     */
 
+    /* Locator Comparison */
+
+    std::vector <named_locator> locators = {{"quadtree", &quad_locator},
+                                            {"linear quadtree", &linear_quad_locator},
+                                            {"slab decomposition", &slab_locator},
+                                            {"persistent slab decomposition", &persistent_slab_locator},
+                                            {"kirkpatrick hierarchy", &kirkpatrick_locator},
+                                            {"trapezoidal map", &trapezoid_locator},
+                                            {"uniform grid", &grid_locator},
+                                            {"hilbert R-tree", &rtree_locator},
+                                            {"oriented walk", &walk_locator}};
+    compare_point_locators_in_random_triangulation(locators, numPoints, uniformDistribution);
+    compare_point_locators_in_random_triangulation(locators, numPoints, clusteredDistribution);
+
+    std::vector <named_locator> subdivision_locators = {{"slab decomposition", &slab_locator},
+                                                        {"persistent slab decomposition", &persistent_slab_locator},
+                                                        {"trapezoidal map", &trapezoid_locator}};
+    compare_point_locators_in_quadrilateral_subdivision(subdivision_locators, 300, 300);
+
+    compare_point_locators_in_zigzag_subdivision(100, 100, 4);
+
+    test_online_point_location(20000, 2000);
+
+    benchmark_slab_search_layouts(20000, 1000000);
+
+    benchmark_parallel_quadtree_construction(numPoints);
+
+    benchmark_quadtree_on_small_extent(numPoints, 0.001);
+
+    benchmark_quadtree_leaf_scan(numPoints);
+
+    benchmark_uniform_grid(numPoints, uniformDistribution);
+    benchmark_uniform_grid(numPoints, clusteredDistribution);
+
+    benchmark_hilbert_rtree(numPoints, 1000000, uniformDistribution);
+    benchmark_hilbert_rtree(numPoints, 1000000, clusteredDistribution);
+
+    benchmark_starting_edge_selection(numPoints);
+
+    benchmark_lawson_walk_policies(numPoints, 10000);
+
+    benchmark_parallel_queries(numPoints, 1000000);
+
+    // Walks from the most recent answer in the given order cross the whole triangulation, so only a small batch is timed for them
+    benchmark_hilbert_sorted_walks(numPoints, 10000, selectRecent);
+    benchmark_hilbert_sorted_walks(numPoints, 1000000, selectGrid);
+    benchmark_hilbert_sorted_walks(numPoints, 10000000, selectGrid);
+
+    benchmark_interleaved_walks(1000000, 1000000);
+    benchmark_lockstep_walks(1000000, 10000);
+
+    benchmark_nearest_neighbors(numPoints, 1000000, 10);
+
+    benchmark_faces_in_box(numPoints, 20);
+
+    test_straight_walks(numPoints, 100000);
+    benchmark_straight_walks(numPoints, 1000000, 0.001);
+    benchmark_straight_walks(numPoints, 10000, 0.1);
+
+    benchmark_frozen_triangulation(numPoints, 1000000);
+
     /* Delaunay Speed Testing */
 
     test_delaunay_condition_for_random_triangulation(10000);